@@ -0,0 +1,118 @@
+/*
+ * bench_seq.cpp
+ *
+ *  Throughput of the seq hot paths for each index type and encoding, on reads and on
+ *  chromosomes (the index types able to address them). Complement and reverse are flags
+ *  applied when elements are read, so these operations are timed up to the chars.
+ */
+
+#include <seq.hpp>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+
+using namespace cppbio;
+
+#define READ_LENGTH 150
+#define CHROMOSOME_LENGTH (1 << 25)
+
+/*
+ * Random chars requiring exactly the encoding e_type.
+ */
+std::string random_chars(encode_type e_type,std::size_t n){
+	std::string alphabet;
+	switch (e_type){
+		case NUC_2BITS: alphabet="ACGT"; break;
+		case NUC_3BITS: alphabet="ACGTACGTN"; break;
+		case NUC_4BITS: alphabet="ACGTACGTACGTNRYKMSWBDHV"; break;
+		default: alphabet="ACDEFGHIKLMNPQRSTVWY"; break;
+	};
+	std::mt19937_64 gen(42);
+	std::uniform_int_distribution<std::size_t> pick(0,alphabet.size() - 1);
+	std::string s(n,'A');
+	for (char & c: s) c=alphabet[pick(gen)];
+	// the widest char at least once
+	s[n / 2]=alphabet.back();
+	return(s);
+}
+
+void set_counters(benchmark::State & state,std::size_t n){
+	state.SetBytesProcessed(state.iterations() * n);
+	state.counters["bases"]=benchmark::Counter(n,benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template<IsAnyOf T_uint>
+void bench_encode(benchmark::State & state,encode_type e_type,std::size_t n){
+	const std::string chars=random_chars(e_type,n);
+	for (auto _: state){
+		seq<T_uint> s(std::string_view(chars),e_type);
+		benchmark::DoNotOptimize(s.get_data());
+	};
+	set_counters(state,n);
+}
+
+template<IsAnyOf T_uint>
+void bench_decode(benchmark::State & state,encode_type e_type,std::size_t n){
+	const seq<T_uint> s(random_chars(e_type,n),e_type);
+	for (auto _: state){
+		std::string chars=s.get_string();
+		benchmark::DoNotOptimize(chars.data());
+	};
+	set_counters(state,n);
+}
+
+template<IsAnyOf T_uint>
+void bench_complement(benchmark::State & state,encode_type e_type,std::size_t n){
+	const seq<T_uint> s(random_chars(e_type,n),e_type);
+	for (auto _: state){
+		seq<T_uint> c(s);
+		c.complement();
+		std::string chars=c.get_string();
+		benchmark::DoNotOptimize(chars.data());
+	};
+	set_counters(state,n);
+}
+
+template<IsAnyOf T_uint>
+void bench_reverse_complement(benchmark::State & state,encode_type e_type,std::size_t n){
+	const seq<T_uint> s(random_chars(e_type,n),e_type);
+	for (auto _: state){
+		seq<T_uint> c(s);
+		c.reverse_complement();
+		std::string chars=c.get_string();
+		benchmark::DoNotOptimize(chars.data());
+	};
+	set_counters(state,n);
+}
+
+template<IsAnyOf T_uint>
+void register_type(const std::string & type){
+	const std::pair<encode_type,std::string> encodings[]={{NUC_2BITS,"NUC_2BITS"},{NUC_3BITS,"NUC_3BITS"},{NUC_4BITS,"NUC_4BITS"},{PRO_5BITS,"PRO_5BITS"}};
+	std::vector<std::pair<std::size_t,std::string>> lengths={{READ_LENGTH,"read"}};
+	if (std::numeric_limits<T_uint>::max() >= CHROMOSOME_LENGTH) lengths.push_back({CHROMOSOME_LENGTH,"chromosome"});
+	for (const auto & [e_type,encoding]: encodings){
+		for (const auto & [n,length]: lengths){
+			const std::string suffix="/" + type + "/" + encoding + "/" + length;
+			benchmark::RegisterBenchmark(("encode" + suffix).c_str(),bench_encode<T_uint>,e_type,n);
+			benchmark::RegisterBenchmark(("decode" + suffix).c_str(),bench_decode<T_uint>,e_type,n);
+			if (e_type==PRO_5BITS) continue;
+			benchmark::RegisterBenchmark(("complement" + suffix).c_str(),bench_complement<T_uint>,e_type,n);
+			benchmark::RegisterBenchmark(("reverse_complement" + suffix).c_str(),bench_reverse_complement<T_uint>,e_type,n);
+		};
+	};
+}
+
+int main(int argc,char ** argv){
+	register_type<uint8_t>("uint8_t");
+	register_type<uint16_t>("uint16_t");
+	register_type<uint32_t>("uint32_t");
+	register_type<uint64_t>("uint64_t");
+	const std::string simd[]={"NONE","SSE42","AVX2"};
+	benchmark::AddCustomContext("codec_simd_level",simd[codec::get_simd_level()]);
+	benchmark::AddCustomContext("codec_n_threads",std::to_string(codec::get_n_threads()));
+	benchmark::Initialize(&argc,argv);
+	if (benchmark::ReportUnrecognizedArguments(argc,argv)) return(1);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return(0);
+}
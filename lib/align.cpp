@@ -0,0 +1,434 @@
+/*
+ * align.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <align.hpp>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(CPPBIO_NO_SIMD)
+#define CPPBIO_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace cppbio;
+
+// Declaration and Definition of objects used only within this scope
+
+namespace {
+
+const int32_t NEG_INF=INT32_MIN / 2;
+
+/*
+ * Rows of the query profile: one per char that any encoding decodes, complemented or not,
+ * so that a target is turned into rows with a single bulk unpack.
+ */
+struct row_table {
+	uint8_t of[128]={}; // chars without row are scored as the one of row 0
+	char chars[32]={};
+	uint8_t n=0;
+
+	row_table(){
+		bool seen[128]={};
+		for (encode_type e: {NUC_2BITS,NUC_3BITS,NUC_4BITS,PRO_5BITS}){
+			codec::visit(e,[this,&seen](auto policy){
+				using P=decltype(policy);
+				for (std::size_t code=0;code<(std::size_t(1) << P::nbits);code++){
+					for (char c: {P::chars[code],codec::complement(P::chars[code])}){
+						if (c=='\0' || seen[(unsigned char) c]) continue;
+						seen[(unsigned char) c]=true;
+						this->of[(unsigned char) c]=this->n;
+						this->chars[this->n++]=c;
+					};
+				};
+			});
+		};
+	};
+};
+
+const row_table rows;
+
+/*
+ * Row of each element of a seq as read.
+ */
+template<IsAnyOf T_uint>
+std::vector<uint8_t> rows_of(const seq<T_uint> & s){
+	std::vector<uint8_t> r(s.size());
+	if (s.size()==0) return(r);
+	char table[32]={};
+	const bool comp=s.get_is_comp();
+	codec::visit(s.get_e_type(),[&table,comp](auto policy){
+		using P=decltype(policy);
+		for (std::size_t code=0;code<(std::size_t(1) << P::nbits);code++){
+			const char c=comp ? codec::complement(P::chars[code]) : P::chars[code];
+			table[code]=rows.of[(unsigned char) c];
+		};
+	});
+	codec::unpack(s.get_e_type(),s.get_data(),s.get_offset(),s.size(),reinterpret_cast<char *>(r.data()),s.get_is_rev(),table);
+	return(r);
+}
+
+const char BLOSUM62_CHARS[]="ARNDCQEGHILKMFPSTWYVBZX*";
+const int8_t BLOSUM62[24][24]={
+	{ 4,-1,-2,-2, 0,-1,-1, 0,-2,-1,-1,-1,-1,-2,-1, 1, 0,-3,-2, 0,-2,-1, 0,-4},
+	{-1, 5, 0,-2,-3, 1, 0,-2, 0,-3,-2, 2,-1,-3,-2,-1,-1,-3,-2,-3,-1, 0,-1,-4},
+	{-2, 0, 6, 1,-3, 0, 0, 0, 1,-3,-3, 0,-2,-3,-2, 1, 0,-4,-2,-3, 3, 0,-1,-4},
+	{-2,-2, 1, 6,-3, 0, 2,-1,-1,-3,-4,-1,-3,-3,-1, 0,-1,-4,-3,-3, 4, 1,-1,-4},
+	{ 0,-3,-3,-3, 9,-3,-4,-3,-3,-1,-1,-3,-1,-2,-3,-1,-1,-2,-2,-1,-3,-3,-2,-4},
+	{-1, 1, 0, 0,-3, 5, 2,-2, 0,-3,-2, 1, 0,-3,-1, 0,-1,-2,-1,-2, 0, 3,-1,-4},
+	{-1, 0, 0, 2,-4, 2, 5,-2, 0,-3,-3, 1,-2,-3,-1, 0,-1,-3,-2,-2, 1, 4,-1,-4},
+	{ 0,-2, 0,-1,-3,-2,-2, 6,-2,-4,-4,-2,-3,-3,-2, 0,-2,-2,-3,-3,-1,-2,-1,-4},
+	{-2, 0, 1,-1,-3, 0, 0,-2, 8,-3,-3,-1,-2,-1,-2,-1,-2,-2, 2,-3, 0, 0,-1,-4},
+	{-1,-3,-3,-3,-1,-3,-3,-4,-3, 4, 2,-3, 1, 0,-3,-2,-1,-3,-1, 3,-3,-3,-1,-4},
+	{-1,-2,-3,-4,-1,-2,-3,-4,-3, 2, 4,-2, 2, 0,-3,-2,-1,-2,-1, 1,-4,-3,-1,-4},
+	{-1, 2, 0,-1,-3, 1, 1,-2,-1,-3,-2, 5,-1,-3,-1, 0,-1,-3,-2,-2, 0, 1,-1,-4},
+	{-1,-1,-2,-3,-1, 0,-2,-3,-2, 1, 2,-1, 5, 0,-2,-1,-1,-1,-1, 1,-3,-1,-1,-4},
+	{-2,-3,-3,-3,-2,-3,-3,-3,-1, 0, 0,-3, 0, 6,-4,-2,-2, 1, 3,-1,-3,-3,-1,-4},
+	{-1,-2,-2,-1,-3,-1,-1,-2,-2,-3,-3,-1,-2,-4, 7,-1,-1,-4,-3,-2,-2,-1,-2,-4},
+	{ 1,-1, 1, 0,-1, 0, 0, 0,-1,-2,-2, 0,-1,-2,-1, 4, 1,-3,-2,-2, 0, 0, 0,-4},
+	{ 0,-1, 0,-1,-1,-1,-1,-2,-2,-1,-1,-1,-1,-2,-1, 1, 5,-2,-2, 0,-1,-1, 0,-4},
+	{-3,-3,-4,-4,-2,-2,-3,-2,-2,-3,-2,-3,-1, 1,-4,-3,-2,11, 2,-3,-4,-3,-2,-4},
+	{-2,-2,-2,-3,-2,-1,-2,-3, 2,-1,-1,-2,-1, 3,-3,-2,-2, 2, 7,-1,-3,-2,-1,-4},
+	{ 0,-3,-3,-3,-1,-2,-2,-3,-3, 3, 1,-2, 1,-1,-2,-2, 0,-3,-1, 4,-3,-2,-1,-4},
+	{-2,-1, 3, 4,-3, 0, 1,-1, 0,-3,-4, 0,-3,-3,-2, 0,-1,-4,-3,-3, 4, 1,-1,-4},
+	{-1, 0, 0, 1,-3, 3, 4,-2, 0,-3,-3, 1,-1,-3,-1, 0,-1,-3,-2,-2, 1, 4,-1,-4},
+	{ 0,-1,-1,-1,-2,-1,-1,-1,-1,-1,-1,-1,-1,-1,-2, 0, 0,-2,-1,-1,-1,-1,-1,-4},
+	{-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4, 1}
+};
+
+#ifdef CPPBIO_X86_SIMD
+
+/*
+ * Lanes of the striped kernel: 16 unsigned 8-bits scores biased by the profile, or
+ * 8 signed 16-bits scores. Gap costs are subtracted with unsigned saturation, so that
+ * scores never go below 0.
+ */
+struct lanes_8 {
+	using T=uint8_t;
+	static constexpr std::size_t n=16;
+	static constexpr int32_t max=UINT8_MAX;
+	__attribute__((target("sse4.2"))) static __m128i set1(int32_t x){ return _mm_set1_epi8((char) x); }
+	__attribute__((target("sse4.2"))) static __m128i add_profile(__m128i h,__m128i p,__m128i bias){ return _mm_subs_epu8(_mm_adds_epu8(h,p),bias); }
+	__attribute__((target("sse4.2"))) static __m128i subs(__m128i a,__m128i b){ return _mm_subs_epu8(a,b); }
+	__attribute__((target("sse4.2"))) static __m128i max_(__m128i a,__m128i b){ return _mm_max_epu8(a,b); }
+	__attribute__((target("sse4.2"))) static __m128i shift(__m128i a){ return _mm_slli_si128(a,1); }
+	__attribute__((target("sse4.2"))) static int32_t hmax(__m128i a){
+		a=_mm_max_epu8(a,_mm_srli_si128(a,8));
+		a=_mm_max_epu8(a,_mm_srli_si128(a,4));
+		a=_mm_max_epu8(a,_mm_srli_si128(a,2));
+		a=_mm_max_epu8(a,_mm_srli_si128(a,1));
+		return _mm_extract_epi8(a,0);
+	}
+};
+
+struct lanes_16 {
+	using T=int16_t;
+	static constexpr std::size_t n=8;
+	static constexpr int32_t max=INT16_MAX;
+	__attribute__((target("sse4.2"))) static __m128i set1(int32_t x){ return _mm_set1_epi16((short) x); }
+	__attribute__((target("sse4.2"))) static __m128i add_profile(__m128i h,__m128i p,__m128i){ return _mm_max_epi16(_mm_adds_epi16(h,p),_mm_setzero_si128()); }
+	__attribute__((target("sse4.2"))) static __m128i subs(__m128i a,__m128i b){ return _mm_subs_epu16(a,b); }
+	__attribute__((target("sse4.2"))) static __m128i max_(__m128i a,__m128i b){ return _mm_max_epi16(a,b); }
+	__attribute__((target("sse4.2"))) static __m128i shift(__m128i a){ return _mm_slli_si128(a,2); }
+	__attribute__((target("sse4.2"))) static int32_t hmax(__m128i a){
+		a=_mm_max_epi16(a,_mm_srli_si128(a,8));
+		a=_mm_max_epi16(a,_mm_srli_si128(a,4));
+		a=_mm_max_epi16(a,_mm_srli_si128(a,2));
+		return (int16_t) _mm_extract_epi16(a,0);
+	}
+};
+
+/*
+ * Striped Smith-Waterman (Farrar 2007) with the lazy-F loop. Query element i is in lane
+ * i / seg of vector i % seg. Returns false when a score saturates the lanes.
+ */
+template<typename L>
+__attribute__((target("sse4.2")))
+bool local_striped(const typename L::T * profile,std::size_t seg,std::size_t m,const std::vector<uint8_t> & target,
+		int32_t gap_open,int32_t gap_extend,int32_t bias,int32_t max_score,alignment & r){
+	// H of the current and previous columns, E, H of the column of the best score (new aligns on 16 bytes)
+	std::vector<uint64_t> buffer(8 * seg,0);
+	__m128i * h_store=(__m128i *) buffer.data();
+	__m128i * h_load=h_store + seg;
+	__m128i * e=h_store + 2 * seg;
+	__m128i * best_column=h_store + 3 * seg;
+	const __m128i v_open=L::set1(gap_open);
+	const __m128i v_extend=L::set1(gap_extend);
+	const __m128i v_bias=L::set1(bias);
+	const __m128i zero=_mm_setzero_si128();
+	int32_t best=0;
+	std::size_t best_j=0;
+	for (std::size_t j=0;j<target.size();j++){
+		const __m128i * p=(const __m128i *) (profile + target[j] * seg * L::n);
+		__m128i f=zero;
+		__m128i column_max=zero;
+		__m128i h=L::shift(h_store[seg - 1]);
+		std::swap(h_load,h_store);
+		for (std::size_t i=0;i<seg;i++){
+			h=L::add_profile(h,_mm_loadu_si128(p + i),v_bias);
+			h=L::max_(h,e[i]);
+			h=L::max_(h,f);
+			column_max=L::max_(column_max,h);
+			h_store[i]=h;
+			h=L::subs(h,v_open);
+			e[i]=L::max_(L::subs(e[i],v_extend),h);
+			f=L::max_(L::subs(f,v_extend),h);
+			h=h_load[i];
+		};
+		// lazy-F: propagate the vertical gaps across the stripes while they improve a score
+		f=L::shift(f);
+		for (std::size_t i=0;;){
+			const __m128i t=L::subs(f,L::subs(h_store[i],v_open));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(t,zero))==0xFFFF) break;
+			h_store[i]=L::max_(h_store[i],f);
+			column_max=L::max_(column_max,h_store[i]);
+			e[i]=L::max_(e[i],L::subs(h_store[i],v_open));
+			f=L::subs(f,v_extend);
+			if (++i>=seg){
+				i=0;
+				f=L::shift(f);
+			};
+		};
+		const int32_t c=L::hmax(column_max);
+		if (c>best){
+			best=c;
+			best_j=j;
+			std::copy(h_store,h_store + seg,best_column);
+			if (best + bias + max_score>=L::max) return(false);
+		};
+	};
+	r.score=best;
+	r.target_end=best ? best_j + 1 : 0;
+	r.query_end=0;
+	if (best){
+		// the first query element ending an alignment of the best score
+		typename L::T lanes[L::n];
+		for (std::size_t i=0;i<m && r.query_end==0;i++){
+			_mm_storeu_si128((__m128i *) lanes,best_column[i % seg]);
+			if (lanes[i / seg]==best) r.query_end=i + 1;
+		};
+	};
+	return(true);
+}
+
+#endif
+
+/*
+ * Striped profile: score of query element l * seg + i (plus bias) against row c in lane l
+ * of vector i of row c. Lanes past the query get the lowest score.
+ */
+template<typename T>
+std::vector<T> striped_profile(const std::vector<uint8_t> & query,const score_matrix & matrix,std::size_t n_lanes,std::size_t seg,int32_t bias,int32_t lowest){
+	std::vector<T> p(rows.n * seg * n_lanes,0);
+	for (std::size_t c=0;c<rows.n;c++){
+		for (std::size_t i=0;i<seg;i++){
+			for (std::size_t l=0;l<n_lanes;l++){
+				const std::size_t q=l * seg + i;
+				const int32_t s=q<query.size() ? matrix.get(rows.chars[query[q]],rows.chars[c]) : lowest;
+				p[(c * seg + i) * n_lanes + l]=T(s + bias);
+			};
+		};
+	};
+	return(p);
+}
+
+}
+
+// SCORE MATRIX
+score_matrix::score_matrix(){
+	std::memset(this->scores,0,sizeof(this->scores));
+};
+
+score_matrix score_matrix::nucleotide(int8_t match,int8_t mismatch){
+	score_matrix m;
+	const char iupac[]="ACGTURYKMSWBDHVN-";
+	for (const char * a=iupac;*a;a++){
+		for (const char * b=iupac;*b;b++){
+			const char ta=(*a=='U') ? 'T' : *a;
+			const char tb=(*b=='U') ? 'T' : *b;
+			m.set(*a,*b,ta==tb ? match : mismatch);
+		};
+	};
+	return(m);
+};
+
+score_matrix score_matrix::blosum62(){
+	score_matrix m;
+	for (std::size_t a=0;a<24;a++){
+		for (std::size_t b=0;b<24;b++) m.set(BLOSUM62_CHARS[a],BLOSUM62_CHARS[b],BLOSUM62[a][b]);
+	};
+	// selenocysteine as cysteine, frameshifts and gaps as stops
+	for (std::size_t b=0;b<24;b++){
+		m.set('U',BLOSUM62_CHARS[b],m.get('C',BLOSUM62_CHARS[b]));
+		m.set('!',BLOSUM62_CHARS[b],m.get('*',BLOSUM62_CHARS[b]));
+		m.set('-',BLOSUM62_CHARS[b],m.get('*',BLOSUM62_CHARS[b]));
+	};
+	m.set('U','U',m.get('C','C'));
+	for (char a: {'!','-'}){
+		for (char b: {'!','-','U'}) m.set(a,b,m.get('*','*'));
+	};
+	m.set('U','!',m.get('C','*'));
+	m.set('U','-',m.get('C','*'));
+	return(m);
+};
+
+void score_matrix::set(char a,char b,int8_t score){
+	this->scores[(unsigned char) a & 0x7F][(unsigned char) b & 0x7F]=score;
+	this->scores[(unsigned char) b & 0x7F][(unsigned char) a & 0x7F]=score;
+};
+
+// ALIGNER
+template<IsAnyOf T_uint>
+aligner<T_uint>::aligner(const seq<T_uint> & in_query,const score_matrix & in_matrix,uint8_t in_gap_open,uint8_t in_gap_extend,align_mode in_mode){
+	SPDLOG_DEBUG("aligner::aligner");
+	if (in_gap_extend>in_gap_open){
+		throw std::invalid_argument("Extending a gap cannot cost more than opening it");
+	};
+	this->matrix=in_matrix;
+	this->gap_open=in_gap_open;
+	this->gap_extend=in_gap_extend;
+	this->mode=in_mode;
+	this->query=rows_of(in_query);
+	int32_t lowest=0;
+	this->max_score=0;
+	for (std::size_t a=0;a<rows.n;a++){
+		for (std::size_t b=0;b<rows.n;b++){
+			lowest=std::min<int32_t>(lowest,this->matrix.get(rows.chars[a],rows.chars[b]));
+			this->max_score=std::max<int32_t>(this->max_score,this->matrix.get(rows.chars[a],rows.chars[b]));
+		};
+	};
+	this->bias=-lowest;
+	this->seg_8=std::max<std::size_t>(1,(this->query.size() + 15) / 16);
+	this->seg_16=std::max<std::size_t>(1,(this->query.size() + 7) / 8);
+	if (this->mode==align_LOCAL){
+		this->profile_8=striped_profile<uint8_t>(this->query,this->matrix,16,this->seg_8,this->bias,lowest);
+		this->profile_16=striped_profile<int16_t>(this->query,this->matrix,8,this->seg_16,0,lowest);
+	};
+};
+
+template<IsAnyOf T_uint>
+alignment aligner<T_uint>::align(const seq<T_uint> & target,bool traceback) const{
+	SPDLOG_DEBUG("aligner::align");
+	const std::vector<uint8_t> t=rows_of(target);
+#ifdef CPPBIO_X86_SIMD
+	if (this->mode==align_LOCAL && !traceback && codec::get_simd_level()!=simd_NONE && !this->query.empty()){
+		alignment r {0,0,0,0,0,""};
+		if (local_striped<lanes_8>(this->profile_8.data(),this->seg_8,this->query.size(),t,this->gap_open,this->gap_extend,this->bias,this->max_score,r)) return(r);
+		SPDLOG_DEBUG("aligner::align 8-bits scores saturated");
+		if (local_striped<lanes_16>(this->profile_16.data(),this->seg_16,this->query.size(),t,this->gap_open,this->gap_extend,0,this->max_score,r)) return(r);
+		SPDLOG_DEBUG("aligner::align 16-bits scores saturated");
+	};
+#endif
+	return(this->align_scalar(t,traceback));
+};
+
+template<IsAnyOf T_uint>
+std::vector<alignment> aligner<T_uint>::align(const std::vector<seq<T_uint>> & targets,bool traceback) const{
+	std::vector<alignment> r;
+	r.reserve(targets.size());
+	for (const seq<T_uint> & t: targets) r.push_back(this->align(t,traceback));
+	return(r);
+};
+
+// INTERNAL FUNCTIONS
+template<IsAnyOf T_uint>
+alignment aligner<T_uint>::align_scalar(const std::vector<uint8_t> & target,bool traceback) const{
+	// Gotoh: H best score ending at (i,j), E ending with a gap in the query (target only),
+	// F ending with a gap in the target (query only)
+	const std::size_t m=this->query.size();
+	const std::size_t n=target.size();
+	const bool local=this->mode==align_LOCAL;
+	enum : uint8_t { FROM_ZERO=0, FROM_DIAG=1, FROM_E=2, FROM_F=3, E_EXTENDED=4, F_EXTENDED=8 };
+	std::vector<uint8_t> trace(traceback ? (m + 1) * (n + 1) : 0,FROM_ZERO);
+	auto gap=[this](std::size_t len){ return(len ? -(this->gap_open + int32_t(len - 1) * this->gap_extend) : 0); };
+	// row i - 1 of H and F, updated in place to row i
+	std::vector<int32_t> h(n + 1),f(n + 1,NEG_INF);
+	for (std::size_t j=0;j<=n;j++){
+		h[j]=(this->mode==align_GLOBAL) ? gap(j) : 0;
+		if (traceback && j && this->mode==align_GLOBAL) trace[j]=FROM_E | (j>1 ? E_EXTENDED : 0);
+	};
+	alignment r {local ? 0 : NEG_INF,0,0,0,0,""};
+	if (!local && m==0){
+		r.score=(this->mode==align_GLOBAL) ? gap(n) : 0;
+		r.target_end=(this->mode==align_GLOBAL) ? n : 0;
+	};
+	for (std::size_t i=1;i<=m;i++){
+		int32_t diag=h[0];
+		h[0]=local ? 0 : gap(i);
+		int32_t e=NEG_INF;
+		if (traceback && !local) trace[i * (n + 1)]=FROM_F | (i>1 ? F_EXTENDED : 0);
+		for (std::size_t j=1;j<=n;j++){
+			uint8_t t=0;
+			const int32_t e_open=h[j - 1] - this->gap_open,e_ext=e - this->gap_extend;
+			if (e_ext>e_open){ e=e_ext; t|=E_EXTENDED; }else{ e=e_open; };
+			const int32_t f_open=h[j] - this->gap_open,f_ext=f[j] - this->gap_extend;
+			if (f_ext>f_open){ f[j]=f_ext; t|=F_EXTENDED; }else{ f[j]=f_open; };
+			const int32_t d=diag + this->matrix.get(rows.chars[this->query[i - 1]],rows.chars[target[j - 1]]);
+			diag=h[j];
+			int32_t best=d;
+			uint8_t from=FROM_DIAG;
+			if (e>best){ best=e; from=FROM_E; };
+			if (f[j]>best){ best=f[j]; from=FROM_F; };
+			if (local && best<=0){ best=0; from=FROM_ZERO; };
+			h[j]=best;
+			if (traceback) trace[i * (n + 1) + j]=t | from;
+			// among equal scores, the lowest target end then query end, as the striped kernel
+			if ((local && (best>r.score || (best==r.score && best && j<r.target_end))) || (this->mode==align_SEMI_GLOBAL && i==m && best>r.score)){
+				r.score=best;
+				r.query_end=i;
+				r.target_end=j;
+			};
+		};
+		if (this->mode==align_SEMI_GLOBAL && i==m && n==0){
+			r.score=h[0];
+			r.query_end=m;
+		};
+	};
+	if (this->mode==align_GLOBAL && m){
+		r.score=h[n];
+		r.query_end=m;
+		r.target_end=n;
+	};
+	if (!traceback) return(r);
+	// walk back from the end, in H, E or F
+	std::string ops;
+	std::size_t i=r.query_end,j=r.target_end;
+	uint8_t state=FROM_DIAG;
+	while (i>0 || j>0){
+		const uint8_t t=trace[i * (n + 1) + j];
+		if (state==FROM_DIAG){
+			// local alignments start after a zero, others on the first row
+			if ((t & 3)==FROM_ZERO) break;
+			if ((t & 3)==FROM_DIAG){
+				ops.push_back('M');
+				i--;
+				j--;
+			}else{
+				state=t & 3;
+			};
+			continue;
+		};
+		if (state==FROM_E){
+			ops.push_back('D');
+			if (!(t & E_EXTENDED)) state=FROM_DIAG;
+			j--;
+		}else{
+			ops.push_back('I');
+			if (!(t & F_EXTENDED)) state=FROM_DIAG;
+			i--;
+		};
+	};
+	r.query_begin=i;
+	r.target_begin=j;
+	// run-length encoding, from the begins
+	for (std::size_t k=ops.size();k>0;){
+		std::size_t len=1;
+		while (len<k && ops[k - 1 - len]==ops[k - 1]) len++;
+		r.cigar+=std::to_string(len) + ops[k - 1];
+		k-=len;
+	};
+	return(r);
+};
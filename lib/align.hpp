@@ -0,0 +1,181 @@
+/*!
+ * @file align.hpp
+ * @brief Pairwise alignment of encoded sequences
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef ALIGN_HPP_
+#define ALIGN_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "seq.hpp"
+
+namespace cppbio {
+
+	/**
+	 * @brief Definition of type `align_mode`
+	 *
+	 * Enumeration of the alignment modes
+	 *
+	 */
+
+	typedef enum {
+		align_LOCAL, /**<  Smith-Waterman: best alignment of a region of the query and a region of the target */
+		align_GLOBAL, /**<  Needleman-Wunsch: the whole query with the whole target */
+		align_SEMI_GLOBAL /**<  the whole query with a region of the target (gaps at the ends of the target are free) */
+	} align_mode ;
+
+	/*!
+	 * @class score_matrix
+	 * @brief Substitution scores between upper case chars
+	 *
+	 */
+	class score_matrix{
+		public:
+			/*!
+			 *  @brief Default constructor
+			 *
+			 *  Every score is 0.
+			 *
+			 */
+			score_matrix();
+			/*!
+			 *  @brief Nucleotide matrix
+			 *
+			 *  Equal IUPAC chars score `match`, the others `mismatch`. U and T are equal.
+			 *
+			 *  @param match : score of a match
+			 *  @param mismatch : score of a mismatch
+			 *  @return the matrix
+			 */
+			static score_matrix nucleotide(int8_t match=2,int8_t mismatch=-3);
+			/*!
+			 *  @brief BLOSUM62 matrix
+			 *
+			 *  U scores as C, frameshifts and gaps as stops.
+			 *
+			 *  @return the matrix
+			 */
+			static score_matrix blosum62();
+			/*!
+			 *  @brief Set the score of two chars
+			 *
+			 *  The matrix stays symmetric.
+			 *
+			 *  @param a : upper case char
+			 *  @param b : upper case char
+			 *  @param score : score of aligning a with b
+			 */
+			void set(char a,char b,int8_t score);
+			/*!
+			 *  @brief Get the score of two chars
+			 *
+			 *  @param a : upper case char
+			 *  @param b : upper case char
+			 *  @return score of aligning a with b
+			 */
+			int8_t get(char a,char b) const{ return(this->scores[(unsigned char) a & 0x7F][(unsigned char) b & 0x7F]); };
+
+		private:
+
+			int8_t scores[128][128]; /**<  score of each pair of chars */
+	};
+
+	/*!
+	 * @struct alignment
+	 * @brief Result of an alignment
+	 *
+	 *  Positions are indexes of the seqs as read, `end` being past the last aligned element.
+ *  Among alignments of equal scores, the one of the lowest target end, then query end, is kept.
+	 *
+	 */
+	struct alignment {
+		int32_t score; /**<  score of the alignment */
+		std::size_t query_begin; /**<  first aligned element of the query (set by the traceback) */
+		std::size_t query_end; /**<  past the last aligned element of the query */
+		std::size_t target_begin; /**<  first aligned element of the target (set by the traceback) */
+		std::size_t target_end; /**<  past the last aligned element of the target */
+		std::string cigar; /**<  M (match or mismatch), I (query only) and D (target only) operations, empty without traceback */
+	};
+
+	/*!
+	 * @class aligner
+	 * @brief Align a query to targets with affine gaps
+	 *
+	 *  The query profile (the score of every query element against every possible target
+	 *  element) is built once by the constructor and reused for every target.
+	 *
+	 *  Local scores are computed with the striped algorithm of Farrar on 16 unsigned 8-bits
+	 *  lanes (SSE4.2), then on 8 signed 16-bits lanes if a score saturates, then with 32-bits
+	 *  scalars if it saturates again. Global and semi-global scores and tracebacks are
+	 *  computed by the scalar Gotoh algorithm, as are all scores when codec::get_simd_level
+	 *  is simd_NONE.
+	 *
+	 *  A gap of length L costs gap_open + (L - 1) * gap_extend.
+	 *
+	 *  @tparam T_uint : index type of the seqs
+	 */
+	template<IsAnyOf T_uint>
+	class aligner{
+		public:
+			/*!
+			 *  @brief Constructor
+			 *
+			 *  @param query : query seq, read as it is (orientation and complement applied)
+			 *  @param matrix : substitution scores
+			 *  @param gap_open : cost of the first element of a gap
+			 *  @param gap_extend : cost of each next element of a gap
+			 *  @param mode : alignment mode
+			 *  @throw std::invalid_argument if gap_extend is larger than gap_open
+			 */
+			aligner(const seq<T_uint> & query,const score_matrix & matrix,uint8_t gap_open=5,uint8_t gap_extend=2,align_mode mode=align_LOCAL);
+			/*!
+			 *  @brief Align the query to a target
+			 *
+			 *  @param target : target seq, read as it is
+			 *  @param traceback : whether the begins and the CIGAR are computed
+			 *	@return the best alignment
+			 */
+			alignment align(const seq<T_uint> & target,bool traceback=false) const;
+			/*!
+			 *  @brief Align the query to targets
+			 *
+			 *  @param targets : target seqs
+			 *  @param traceback : whether the begins and the CIGARs are computed
+			 *	@return the best alignment with each target
+			 */
+			std::vector<alignment> align(const std::vector<seq<T_uint>> & targets,bool traceback=false) const;
+
+		private:
+
+			// ATTRIBUTES
+
+			score_matrix matrix; /**<  substitution scores */
+			int32_t gap_open; /**<  cost of the first element of a gap */
+			int32_t gap_extend; /**<  cost of each next element of a gap */
+			align_mode mode; /**<  alignment mode */
+			std::vector<uint8_t> query; /**<  row of each query element */
+			std::size_t seg_8; /**<  number of 16 x 8-bits vectors striping the query */
+			std::size_t seg_16; /**<  number of 8 x 16-bits vectors striping the query */
+			uint8_t bias; /**<  added to the 8-bits profile so that it is unsigned */
+			int32_t max_score; /**<  highest substitution score */
+			std::vector<uint8_t> profile_8; /**<  biased scores of the striped query for each row */
+			std::vector<int16_t> profile_16; /**<  scores of the striped query for each row */
+
+			// INTERNAL FUNCTIONS
+
+			alignment align_scalar(const std::vector<uint8_t> & target,bool traceback) const;
+	};
+
+	template class aligner<uint8_t>;
+	template class aligner<uint16_t>;
+	template class aligner<uint32_t>;
+	template class aligner<uint64_t>;
+}
+
+#endif /* ALIGN_HPP_ */
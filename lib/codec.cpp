@@ -0,0 +1,875 @@
+/*
+ * codec.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <codec.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(CPPBIO_NO_SIMD)
+#define CPPBIO_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace cppbio;
+
+// Declaration and Definition of objects used only within this scope
+
+namespace {
+
+const uint8_t NO_CODE=0xFF;
+const uint8_t MAX_SPECIALS=3;
+
+/*
+ * Encoding table of a policy: each char is encoded by the first code decoded as this char.
+ * Letters are case insensitive, other chars are called specials.
+ */
+struct alphabet {
+	uint8_t nbits;
+	std::array<uint8_t,256> codes; // char -> code or NO_CODE
+	std::array<uint8_t,32> letters; // code of the char 0x40 + k, for SIMD shuffles
+	uint8_t n_specials;
+	char special_chars[MAX_SPECIALS];
+	uint8_t special_codes[MAX_SPECIALS];
+	const char * error_msg;
+};
+
+template<typename P>
+constexpr alphabet make_alphabet(const char * error_msg){
+	alphabet a {P::nbits,{},{},0,{},{},error_msg};
+	for (auto & c : a.codes) c=NO_CODE;
+	for (uint8_t k=0; k<(1 << P::nbits); k++){
+		unsigned char c=P::chars[k];
+		if (c=='\0' || a.codes[c]!=NO_CODE) continue;
+		a.codes[c]=k;
+		if (c>='A' && c<='Z'){
+			a.codes[c-'A'+'a']=k;
+		}else{
+			a.special_chars[a.n_specials]=c;
+			a.special_codes[a.n_specials]=k;
+			a.n_specials++;
+		}
+	}
+	if (P::e_type!=PRO_5BITS){ // RNA is read with the code of T
+		a.codes['U']=a.codes['u']=a.codes['T'];
+	}
+	for (uint8_t k=0; k<32; k++) a.letters[k]=a.codes[0x40 + k];
+	return a;
+}
+
+template<typename P> constexpr alphabet alphabet_of={};
+template<> constexpr alphabet alphabet_of<codec::policy<NUC_2BITS>> =make_alphabet<codec::policy<NUC_2BITS>>("Input char cannot be encoded as 2-bits DNA (ATCG only):");
+template<> constexpr alphabet alphabet_of<codec::policy<NUC_3BITS>> =make_alphabet<codec::policy<NUC_3BITS>>("Input char cannot be encoded as 3-bits DNA (ATCG-N only):");
+template<> constexpr alphabet alphabet_of<codec::policy<NUC_4BITS>> =make_alphabet<codec::policy<NUC_4BITS>>("Input char cannot be encoded as 4-bits DNA (IUPAC letter and '-' for gap only):");
+template<> constexpr alphabet alphabet_of<codec::policy<PRO_5BITS>> =make_alphabet<codec::policy<PRO_5BITS>>("Input char cannot be encoded as 5-bits protein (amino-acid letter, '-' for gap, '*' for stop and '!' for frameshift only):");
+
+/*
+ * Class of each char (see char_class), letters are case insensitive.
+ * The non-letter chars are the specials of the SIMD translation.
+ */
+struct class_table {
+	std::array<uint8_t,256> of;
+	std::array<uint8_t,32> letters; // class of the char 0x40 + k, for SIMD shuffles
+	char special_chars[MAX_SPECIALS];
+	uint8_t special_classes[MAX_SPECIALS];
+};
+
+struct class_members {
+	const char * chars;
+	uint8_t char_class;
+};
+
+constexpr class_table make_class_table(){
+	class_table t {{},{},{'-','*','!'},{class_NUC_3BITS,class_PRO_5BITS,class_PRO_5BITS}};
+	const class_members letters[]={
+		{"ACGT",class_NUC_2BITS},
+		{"U",class_RNA},
+		{"N",class_NUC_3BITS},
+		{"RKBSWHVMYD",class_NUC_4BITS},
+		{"EFILPQXZ",class_PRO_5BITS}
+	};
+	for (auto & c : t.of) c=class_INVALID;
+	for (const class_members & m : letters){
+		for (const char * c=m.chars; *c; c++){
+			t.of[(unsigned char) *c]=m.char_class;
+			t.of[(unsigned char) (*c - 'A' + 'a')]=m.char_class;
+		}
+	}
+	for (uint8_t k=0; k<MAX_SPECIALS; k++) t.of[(unsigned char) t.special_chars[k]]=t.special_classes[k];
+	for (uint8_t k=0; k<32; k++) t.letters[k]=t.of[0x40 + k];
+	return t;
+}
+
+constexpr class_table char_classes=make_class_table();
+
+[[noreturn]] void throw_unexpected_char(const alphabet & a, char c){
+	std::string msg=a.error_msg;
+	msg.push_back(c);
+	throw std::invalid_argument(msg);
+}
+
+simd_level detect_simd_level(){
+#ifdef CPPBIO_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2")) return simd_AVX2;
+	if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("ssse3")) return simd_SSE42;
+#endif
+	return simd_NONE;
+}
+
+simd_level & current_simd_level(){
+	static simd_level level=detect_simd_level();
+	return level;
+}
+
+// PARALLEL CHUNKS
+
+/*
+ * Settings read by every thread running a kernel, hence atomic. The extra threads are a
+ * budget shared by all the calls in flight: the callers on the user threads (or on the
+ * workers of kmer_counter) take what is left of n_threads - 1 and run the rest of their
+ * chunks themselves, so that concurrent calls never start more than n_threads - 1 threads.
+ */
+struct parallelism {
+	std::atomic<unsigned int> n_threads=std::max(1U,std::thread::hardware_concurrency());
+	std::atomic<std::size_t> chunk_size=std::size_t(1) << 22;
+	std::atomic<unsigned int> n_busy=0;
+};
+
+parallelism & current_parallelism(){
+	static parallelism p;
+	return p;
+}
+
+// set on the threads started by for_chunks, whose kernels never split again
+thread_local bool in_chunk_worker=false;
+
+/*
+ * Take up to n extra threads from the budget, return how many were taken.
+ */
+unsigned int acquire_threads(parallelism & p,unsigned int n){
+	unsigned int busy=p.n_busy.load();
+	unsigned int taken=0;
+	do {
+		const unsigned int limit=p.n_threads.load() - 1;
+		taken=busy < limit ? std::min(n,limit - busy) : 0;
+		if (!taken) return 0;
+	} while (!p.n_busy.compare_exchange_weak(busy,busy + taken));
+	return taken;
+}
+
+/*
+ * Run f(first,n) on the elements [pos,pos+n[ split at the multiples of the chunk size,
+ * itself a multiple of 8, so that every chunk starts on a byte whatever the encoding.
+ * Threads take the chunks in turn. The exception of the lowest chunk is rethrown once
+ * the threads are joined, as the serial run would have raised it.
+ */
+template<typename F>
+void for_chunks(std::size_t pos, std::size_t n, F && f){
+	parallelism & p=current_parallelism();
+	const std::size_t chunk_size=p.chunk_size.load();
+	if (in_chunk_worker || p.n_threads.load()<=1 || n<=chunk_size){
+		f(pos,n);
+		return;
+	}
+	const std::size_t first=pos / chunk_size;
+	const std::size_t n_chunks=(pos + n - 1) / chunk_size - first + 1;
+	const unsigned int n_extra=acquire_threads(p,unsigned(std::min<std::size_t>(n_chunks - 1,UINT_MAX)));
+	if (!n_extra){
+		f(pos,n);
+		return;
+	}
+	std::vector<std::exception_ptr> errors(n_chunks);
+	std::atomic<std::size_t> next(0);
+	auto work=[&f,&errors,&next,pos,n,first,n_chunks,chunk_size](){
+		for (std::size_t c=next++; c<n_chunks; c=next++){
+			const std::size_t lo=std::max(pos,(first + c) * chunk_size);
+			const std::size_t hi=std::min(pos + n,(first + c + 1) * chunk_size);
+			try {
+				f(lo,hi - lo);
+			} catch (...){
+				errors[c]=std::current_exception();
+			}
+		}
+	};
+	std::vector<std::thread> threads;
+	try {
+		for (unsigned int t=0; t<n_extra; t++){
+			threads.emplace_back([&work](){
+				in_chunk_worker=true;
+				work();
+			});
+		}
+	} catch (...){
+		// the chunks left are run below
+	}
+	p.n_busy-=n_extra - unsigned(threads.size());
+	work();
+	for (std::thread & th: threads) th.join();
+	p.n_busy-=unsigned(threads.size());
+	for (const std::exception_ptr & e: errors){
+		if (e) std::rethrow_exception(e);
+	}
+}
+
+// SCALAR KERNELS
+
+/*
+ * Pack the longest prefix of n chars made of blocks of 8 encodable chars, or of all of them,
+ * starting at a multiple of 8 elements so that out is byte-aligned. Blocks of 8 elements give
+ * exactly nbits bytes; the tail goes through a bit accumulator. Return the packed length.
+ */
+template<typename P>
+std::size_t pack_scalar(const char * s, std::size_t n, std::byte * out, uint8_t & classes){
+	const alphabet & a=alphabet_of<P>;
+	constexpr uint8_t nbits=P::nbits;
+	std::size_t i=0;
+	for (; i+8<=n; i+=8){
+		uint64_t block=0;
+		uint8_t block_classes=0;
+		bool invalid=false;
+		for (uint8_t k=0; k<8; k++){
+			const unsigned char c=s[i+k];
+			invalid|=(a.codes[c]==NO_CODE);
+			block=(block << nbits) | a.codes[c];
+			block_classes|=char_classes.of[c];
+		}
+		if (invalid) return i;
+		classes|=block_classes;
+		for (uint8_t b=0; b<nbits; b++){
+			*out++=std::byte(block >> (CHAR_BIT * (nbits - 1 - b)));
+		}
+	}
+	for (std::size_t k=i; k<n; k++){
+		if (a.codes[(unsigned char) s[k]]==NO_CODE) return i;
+	}
+	uint32_t acc=0;
+	uint8_t nacc=0;
+	for (; i<n; i++){
+		acc=(acc << nbits) | a.codes[(unsigned char) s[i]];
+		classes|=char_classes.of[(unsigned char) s[i]];
+		nacc+=nbits;
+		if (nacc>=CHAR_BIT){
+			nacc-=CHAR_BIT;
+			*out++=std::byte(acc >> nacc);
+		}
+	}
+	// shift the final bits if required
+	if (nacc) *out=std::byte(acc << (CHAR_BIT - nacc));
+	return n;
+}
+
+/*
+ * Unpack the output blocks [j0,n_groups[ of n_groups groups of 8 elements (nbits bytes each).
+ * Block j is the group j, or the group n_groups-1-j read backward when rev is set.
+ */
+template<typename P>
+void unpack_scalar(const std::byte * g, std::size_t n_groups, std::size_t j0, char * out, bool rev, const char * chars){
+	constexpr uint8_t nbits=P::nbits;
+	constexpr uint64_t mask=(1 << nbits) - 1;
+	for (std::size_t j=j0; j<n_groups; j++){
+		const std::byte * src=g + (rev ? n_groups - 1 - j : j) * nbits;
+		uint64_t block=0;
+		for (uint8_t b=0; b<nbits; b++) block=(block << CHAR_BIT) | std::to_integer<uint64_t>(src[b]);
+		char * dst=out + j * 8;
+		for (uint8_t k=0; k<8; k++){
+			dst[rev ? 7 - k : k]=chars[(block >> (nbits * (7 - k))) & mask];
+		}
+	}
+}
+
+/*
+ * Group of 8 elements starting at any bit of in, as the 8*nbits low bits of a word with the
+ * first element in the most significant bits. Only the bytes holding the group are read.
+ */
+template<uint8_t NBITS>
+inline uint64_t load_group(const std::byte * in, std::size_t bit){
+	const std::byte * b=in + bit / CHAR_BIT;
+	const uint8_t shift=bit % CHAR_BIT;
+	const uint8_t n_bytes=(shift + 8 * NBITS + CHAR_BIT - 1) / CHAR_BIT;
+	uint64_t w=0;
+	for (uint8_t k=0; k<n_bytes; k++) w=(w << CHAR_BIT) | std::to_integer<uint64_t>(b[k]);
+	return (w >> (n_bytes * CHAR_BIT - shift - 8 * NBITS)) & ((uint64_t(1) << (8 * NBITS)) - 1);
+}
+
+template<uint8_t NBITS>
+inline uint64_t reverse_group(uint64_t w){
+	constexpr uint64_t mask=(1 << NBITS) - 1;
+	uint64_t r=0;
+	for (uint8_t k=0; k<8; k++) r=(r << NBITS) | ((w >> (NBITS * k)) & mask);
+	return r;
+}
+
+/*
+ * Write the output groups [j0,n/8[ of the elements [pos,pos+n[ in reverse order, then the
+ * tail. Output group j is read from the 8 input elements ending 8*j elements before the last
+ * one, wherever they start in a byte, so that the padding of the input is never moved.
+ */
+template<typename P>
+void reverse_scalar(const std::byte * in, std::size_t pos, std::size_t n, std::size_t j0, std::byte * out){
+	constexpr uint8_t nbits=P::nbits;
+	const std::size_t n_groups=n / 8;
+	for (std::size_t j=j0; j<n_groups; j++){
+		const uint64_t w=reverse_group<nbits>(load_group<nbits>(in,(pos + n - 8 * (j + 1)) * nbits));
+		for (uint8_t b=0; b<nbits; b++) out[j * nbits + b]=std::byte(w >> (CHAR_BIT * (nbits - 1 - b)));
+	}
+	// the first input elements are the last output ones
+	uint32_t acc=0;
+	uint8_t nacc=0;
+	std::byte * o=out + n_groups * nbits;
+	for (std::size_t k=n % 8; k-- > 0;){
+		acc=(acc << nbits) | codec::get_code<P>(in,pos + k);
+		nacc+=nbits;
+		if (nacc>=CHAR_BIT){
+			nacc-=CHAR_BIT;
+			*o++=std::byte(acc >> nacc);
+		}
+	}
+	if (nacc) *o=std::byte(acc << (CHAR_BIT - nacc));
+}
+
+#ifdef CPPBIO_X86_SIMD
+
+// SSE4.2 KERNELS
+
+/*
+ * Translate 16 chars into codes and classes: letters use two 16-entries shuffles selected
+ * by bit 4, non-letters become NO_CODE and class_INVALID unless they are specials.
+ */
+__attribute__((target("sse4.2")))
+inline __m128i translate_sse42(const alphabet & a, __m128i c, const __m128i * tables, __m128i & cls){
+	const __m128i m0F=_mm_set1_epi8(0x0F);
+	const __m128i m10=_mm_set1_epi8(0x10);
+	const __m128i mC0=_mm_set1_epi8((char) 0xC0);
+	const __m128i v40=_mm_set1_epi8(0x40);
+	const __m128i idx=_mm_and_si128(c,m0F);
+	const __m128i is_hi=_mm_cmpeq_epi8(_mm_and_si128(c,m10),m10);
+	const __m128i is_letter=_mm_cmpeq_epi8(_mm_and_si128(c,mC0),v40);
+	__m128i code=_mm_blendv_epi8(_mm_shuffle_epi8(tables[0],idx),_mm_shuffle_epi8(tables[1],idx),is_hi);
+	code=_mm_or_si128(_mm_and_si128(is_letter,code),_mm_andnot_si128(is_letter,_mm_set1_epi8((char) NO_CODE)));
+	for (uint8_t k=0; k<a.n_specials; k++){
+		code=_mm_blendv_epi8(code,_mm_set1_epi8(a.special_codes[k]),_mm_cmpeq_epi8(c,_mm_set1_epi8(a.special_chars[k])));
+	}
+	cls=_mm_blendv_epi8(_mm_shuffle_epi8(tables[2],idx),_mm_shuffle_epi8(tables[3],idx),is_hi);
+	cls=_mm_or_si128(_mm_and_si128(is_letter,cls),_mm_andnot_si128(is_letter,_mm_set1_epi8((char) class_INVALID)));
+	for (uint8_t k=0; k<MAX_SPECIALS; k++){
+		cls=_mm_blendv_epi8(cls,_mm_set1_epi8(char_classes.special_classes[k]),_mm_cmpeq_epi8(c,_mm_set1_epi8(char_classes.special_chars[k])));
+	}
+	return code;
+}
+
+// OR of the 16 bytes of a vector
+__attribute__((target("sse4.2")))
+inline uint8_t reduce_or_sse42(__m128i v){
+	v=_mm_or_si128(v,_mm_srli_si128(v,8));
+	v=_mm_or_si128(v,_mm_srli_si128(v,4));
+	v=_mm_or_si128(v,_mm_srli_si128(v,2));
+	v=_mm_or_si128(v,_mm_srli_si128(v,1));
+	return _mm_cvtsi128_si32(v) & 0xFF;
+}
+
+/*
+ * Gather 16 codes (one per byte) into 2 blocks of 8 elements.
+ * Each 64-bits lane ends with its 8*NBITS bits, written big-endian in the first 2*NBITS bytes.
+ */
+template<uint8_t NBITS>
+__attribute__((target("sse4.2")))
+inline __m128i merge_codes_sse42(__m128i code, __m128i order){
+	const __m128i w=_mm_maddubs_epi16(code,_mm_set1_epi16((1 << 8) | (1 << NBITS)));
+	const __m128i d=_mm_madd_epi16(w,_mm_set1_epi32((1 << 16) | (1 << (2 * NBITS))));
+	const __m128i q=_mm_or_si128(_mm_slli_epi64(_mm_and_si128(d,_mm_set1_epi64x(0xFFFFFFFF)),4 * NBITS),_mm_srli_epi64(d,32));
+	return _mm_shuffle_epi8(q,order);
+}
+
+/*
+ * Shuffle control taking the NBITS low bytes of each 64-bits lane in big-endian order.
+ */
+template<uint8_t NBITS>
+void merge_order(int8_t * order){
+	for (uint8_t b=0; b<16; b++) order[b]=-1;
+	for (uint8_t b=0; b<NBITS; b++){
+		order[b]=NBITS - 1 - b;
+		order[NBITS + b]=8 + NBITS - 1 - b;
+	}
+}
+
+template<uint8_t NBITS>
+__attribute__((target("sse4.2")))
+std::size_t pack_sse42(const alphabet & a, const char * s, std::size_t n, std::byte * out, uint8_t & classes){
+	const __m128i tables[4]={
+		_mm_loadu_si128((const __m128i *) a.letters.data()),
+		_mm_loadu_si128((const __m128i *) (a.letters.data() + 16)),
+		_mm_loadu_si128((const __m128i *) char_classes.letters.data()),
+		_mm_loadu_si128((const __m128i *) (char_classes.letters.data() + 16))
+	};
+	const __m128i no_code=_mm_set1_epi8((char) NO_CODE);
+	alignas(16) int8_t order[16];
+	merge_order<NBITS>(order);
+	const __m128i order_v=_mm_load_si128((const __m128i *) order);
+	alignas(16) std::byte packed[16];
+	__m128i acc=_mm_setzero_si128();
+	std::size_t i=0;
+	for (; i+16<=n; i+=16){
+		__m128i cls;
+		const __m128i code=translate_sse42(a,_mm_loadu_si128((const __m128i *) (s + i)),tables,cls);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(code,no_code))) break; // the scalar kernel stops there too
+		acc=_mm_or_si128(acc,cls);
+		_mm_store_si128((__m128i *) packed,merge_codes_sse42<NBITS>(code,order_v));
+		std::memcpy(out + (i / 8) * NBITS,packed,2 * NBITS);
+	}
+	classes|=reduce_or_sse42(acc);
+	return i;
+}
+
+/*
+ * Reverse 16 bytes of input (64 elements of 2 bits or 32 of 4 bits) per iteration: the bytes
+ * are shifted to the element boundary, reversed with a shuffle, then their nibbles are swapped
+ * and, for 2 bits, the crumbs of each nibble. Return the number of output groups written.
+ */
+template<uint8_t NBITS>
+__attribute__((target("sse4.2")))
+std::size_t reverse_sse42(const std::byte * in, std::size_t pos, std::size_t n, std::byte * out){
+	static_assert(NBITS==2 || NBITS==4);
+	constexpr std::size_t per_vector=16 * CHAR_BIT / NBITS;
+	const __m128i reverse_bytes=_mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+	const __m128i swap_crumbs=_mm_setr_epi8(0x0,0x4,0x8,0xC,0x1,0x5,0x9,0xD,0x2,0x6,0xA,0xE,0x3,0x7,0xB,0xF);
+	const __m128i m0F=_mm_set1_epi8(0x0F);
+	std::size_t j=0;
+	for (; (j + 1) * per_vector<=n; j++){
+		const std::size_t bit=(pos + n - (j + 1) * per_vector) * NBITS;
+		const std::byte * b=in + bit / CHAR_BIT;
+		const uint8_t shift=bit % CHAR_BIT;
+		__m128i v=_mm_loadu_si128((const __m128i *) b);
+		if (shift){
+			// the 17th byte belongs to the input as the elements end after it starts
+			const __m128i next=_mm_loadu_si128((const __m128i *) (b + 1));
+			v=_mm_or_si128(
+				_mm_and_si128(_mm_sll_epi16(v,_mm_cvtsi32_si128(shift)),_mm_set1_epi8((char) (0xFF << shift))),
+				_mm_and_si128(_mm_srl_epi16(next,_mm_cvtsi32_si128(CHAR_BIT - shift)),_mm_set1_epi8((char) (0xFF >> (CHAR_BIT - shift)))));
+		}
+		v=_mm_shuffle_epi8(v,reverse_bytes);
+		__m128i hi=_mm_and_si128(_mm_srli_epi16(v,4),m0F);
+		__m128i lo=_mm_and_si128(v,m0F);
+		if constexpr (NBITS==2){
+			hi=_mm_shuffle_epi8(swap_crumbs,hi);
+			lo=_mm_shuffle_epi8(swap_crumbs,lo);
+		}
+		_mm_storeu_si128((__m128i *) (out + j * 16),_mm_or_si128(_mm_slli_epi16(lo,4),hi));
+	}
+	return j * per_vector / 8;
+}
+
+// AVX2 KERNELS
+
+__attribute__((target("avx2")))
+inline __m256i translate_avx2(const alphabet & a, __m256i c, const __m256i * tables, __m256i & cls){
+	const __m256i m0F=_mm256_set1_epi8(0x0F);
+	const __m256i m10=_mm256_set1_epi8(0x10);
+	const __m256i mC0=_mm256_set1_epi8((char) 0xC0);
+	const __m256i v40=_mm256_set1_epi8(0x40);
+	const __m256i idx=_mm256_and_si256(c,m0F);
+	const __m256i is_hi=_mm256_cmpeq_epi8(_mm256_and_si256(c,m10),m10);
+	const __m256i is_letter=_mm256_cmpeq_epi8(_mm256_and_si256(c,mC0),v40);
+	__m256i code=_mm256_blendv_epi8(_mm256_shuffle_epi8(tables[0],idx),_mm256_shuffle_epi8(tables[1],idx),is_hi);
+	code=_mm256_or_si256(_mm256_and_si256(is_letter,code),_mm256_andnot_si256(is_letter,_mm256_set1_epi8((char) NO_CODE)));
+	for (uint8_t k=0; k<a.n_specials; k++){
+		code=_mm256_blendv_epi8(code,_mm256_set1_epi8(a.special_codes[k]),_mm256_cmpeq_epi8(c,_mm256_set1_epi8(a.special_chars[k])));
+	}
+	cls=_mm256_blendv_epi8(_mm256_shuffle_epi8(tables[2],idx),_mm256_shuffle_epi8(tables[3],idx),is_hi);
+	cls=_mm256_or_si256(_mm256_and_si256(is_letter,cls),_mm256_andnot_si256(is_letter,_mm256_set1_epi8((char) class_INVALID)));
+	for (uint8_t k=0; k<MAX_SPECIALS; k++){
+		cls=_mm256_blendv_epi8(cls,_mm256_set1_epi8(char_classes.special_classes[k]),_mm256_cmpeq_epi8(c,_mm256_set1_epi8(char_classes.special_chars[k])));
+	}
+	return code;
+}
+
+template<uint8_t NBITS>
+__attribute__((target("avx2")))
+inline __m256i merge_codes_avx2(__m256i code, __m256i order){
+	const __m256i w=_mm256_maddubs_epi16(code,_mm256_set1_epi16((1 << 8) | (1 << NBITS)));
+	const __m256i d=_mm256_madd_epi16(w,_mm256_set1_epi32((1 << 16) | (1 << (2 * NBITS))));
+	const __m256i q=_mm256_or_si256(_mm256_slli_epi64(_mm256_and_si256(d,_mm256_set1_epi64x(0xFFFFFFFF)),4 * NBITS),_mm256_srli_epi64(d,32));
+	return _mm256_shuffle_epi8(q,order);
+}
+
+template<uint8_t NBITS>
+__attribute__((target("avx2")))
+std::size_t pack_avx2(const alphabet & a, const char * s, std::size_t n, std::byte * out, uint8_t & classes){
+	const __m256i tables[4]={
+		_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) a.letters.data())),
+		_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (a.letters.data() + 16))),
+		_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) char_classes.letters.data())),
+		_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (char_classes.letters.data() + 16)))
+	};
+	const __m256i no_code=_mm256_set1_epi8((char) NO_CODE);
+	alignas(16) int8_t order[16];
+	merge_order<NBITS>(order);
+	const __m256i order_v=_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *) order));
+	alignas(32) std::byte packed[32];
+	__m256i acc=_mm256_setzero_si256();
+	std::size_t i=0;
+	for (; i+32<=n; i+=32){
+		__m256i cls;
+		const __m256i code=translate_avx2(a,_mm256_loadu_si256((const __m256i *) (s + i)),tables,cls);
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(code,no_code))) break; // the scalar kernel stops there too
+		acc=_mm256_or_si256(acc,cls);
+		_mm256_store_si256((__m256i *) packed,merge_codes_avx2<NBITS>(code,order_v));
+		std::memcpy(out + (i / 8) * NBITS,packed,2 * NBITS);
+		std::memcpy(out + (i / 8) * NBITS + 2 * NBITS,packed + 16,2 * NBITS);
+	}
+	classes|=reduce_or_sse42(_mm_or_si128(_mm256_castsi256_si128(acc),_mm256_extracti128_si256(acc,1)));
+	return i;
+}
+
+// SIMD UNPACKING KERNELS
+
+/*
+ * 2-bits: 4 groups (8 bytes) give 32 chars. Crumbs of each byte are split in 4 vectors
+ * then interleaved back in reading order, and translated with a 16-entries shuffle.
+ */
+template<bool REV>
+__attribute__((target("sse4.2")))
+std::size_t unpack_2bits_sse42(const std::byte * g, std::size_t n_groups, char * out, __m128i table){
+	const __m128i m03=_mm_set1_epi8(0x03);
+	const __m128i reverse_bytes=_mm_setr_epi8(7,6,5,4,3,2,1,0,-1,-1,-1,-1,-1,-1,-1,-1);
+	std::size_t j=0;
+	for (; j+4<=n_groups; j+=4){
+		__m128i b=_mm_loadl_epi64((const __m128i *) (g + (REV ? n_groups - j - 4 : j) * 2));
+		if (REV) b=_mm_shuffle_epi8(b,reverse_bytes);
+		const __m128i s0=_mm_and_si128(_mm_srli_epi16(b,6),m03);
+		const __m128i s1=_mm_and_si128(_mm_srli_epi16(b,4),m03);
+		const __m128i s2=_mm_and_si128(_mm_srli_epi16(b,2),m03);
+		const __m128i s3=_mm_and_si128(b,m03);
+		const __m128i a=REV ? _mm_unpacklo_epi8(s3,s2) : _mm_unpacklo_epi8(s0,s1);
+		const __m128i c=REV ? _mm_unpacklo_epi8(s1,s0) : _mm_unpacklo_epi8(s2,s3);
+		_mm_storeu_si128((__m128i *) (out + j * 8),_mm_shuffle_epi8(table,_mm_unpacklo_epi16(a,c)));
+		_mm_storeu_si128((__m128i *) (out + j * 8 + 16),_mm_shuffle_epi8(table,_mm_unpackhi_epi16(a,c)));
+	}
+	return j;
+}
+
+/*
+ * 4-bits: 4 groups (16 bytes) give 32 chars, nibbles are interleaved then translated.
+ */
+template<bool REV>
+__attribute__((target("sse4.2")))
+std::size_t unpack_4bits_sse42(const std::byte * g, std::size_t n_groups, char * out, __m128i table){
+	const __m128i m0F=_mm_set1_epi8(0x0F);
+	const __m128i reverse_bytes=_mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+	std::size_t j=0;
+	for (; j+4<=n_groups; j+=4){
+		__m128i b=_mm_loadu_si128((const __m128i *) (g + (REV ? n_groups - j - 4 : j) * 4));
+		if (REV) b=_mm_shuffle_epi8(b,reverse_bytes);
+		const __m128i hi=_mm_and_si128(_mm_srli_epi16(b,4),m0F);
+		const __m128i lo=_mm_and_si128(b,m0F);
+		_mm_storeu_si128((__m128i *) (out + j * 8),_mm_shuffle_epi8(table,REV ? _mm_unpacklo_epi8(lo,hi) : _mm_unpacklo_epi8(hi,lo)));
+		_mm_storeu_si128((__m128i *) (out + j * 8 + 16),_mm_shuffle_epi8(table,REV ? _mm_unpackhi_epi8(lo,hi) : _mm_unpackhi_epi8(hi,lo)));
+	}
+	return j;
+}
+
+/*
+ * Odd widths: each group is loaded as a big-endian word and its codes are deposited
+ * one per byte with pdep, 2 groups then go through the shuffle translation.
+ */
+template<uint8_t NBITS, bool REV>
+__attribute__((target("avx2,bmi2")))
+inline uint64_t deposit_group(const std::byte * src){
+	uint64_t word=0;
+	std::memcpy(&word,src,NBITS);
+	word=__builtin_bswap64(word) >> (64 - CHAR_BIT * NBITS);
+	const uint64_t codes=_pdep_u64(word,0x0101010101010101ULL * ((1 << NBITS) - 1)); // byte k holds element 7-k
+	return REV ? codes : __builtin_bswap64(codes);
+}
+
+template<uint8_t NBITS, bool REV>
+__attribute__((target("avx2,bmi2")))
+std::size_t unpack_odd_avx2(const std::byte * g, std::size_t n_groups, char * out, __m128i table_lo, __m128i table_hi){
+	std::size_t j=0;
+	for (; j+2<=n_groups; j+=2){
+		const __m128i codes=REV ?
+			_mm_set_epi64x(deposit_group<NBITS,REV>(g + (n_groups - j - 2) * NBITS),deposit_group<NBITS,REV>(g + (n_groups - j - 1) * NBITS)) :
+			_mm_set_epi64x(deposit_group<NBITS,REV>(g + (j + 1) * NBITS),deposit_group<NBITS,REV>(g + j * NBITS));
+		__m128i chars=_mm_shuffle_epi8(table_lo,codes);
+		if (NBITS>4) chars=_mm_blendv_epi8(chars,_mm_shuffle_epi8(table_hi,codes),_mm_cmpgt_epi8(codes,_mm_set1_epi8(15)));
+		_mm_storeu_si128((__m128i *) (out + j * 8),chars);
+	}
+	return j;
+}
+
+template<typename P>
+std::size_t unpack_simd(const std::byte * g, std::size_t n_groups, char * out, bool rev, const char * chars){
+	const simd_level level=current_simd_level();
+	if (level==simd_NONE) return 0;
+	alignas(16) char table[32]={};
+	std::memcpy(table,chars,1 << P::nbits);
+	const __m128i table_lo=_mm_load_si128((const __m128i *) table);
+	const __m128i table_hi=_mm_load_si128((const __m128i *) (table + 16));
+	if constexpr (P::nbits==2){
+		return rev ? unpack_2bits_sse42<true>(g,n_groups,out,table_lo) : unpack_2bits_sse42<false>(g,n_groups,out,table_lo);
+	}else if constexpr (P::nbits==4){
+		return rev ? unpack_4bits_sse42<true>(g,n_groups,out,table_lo) : unpack_4bits_sse42<false>(g,n_groups,out,table_lo);
+	}else{
+		if (level!=simd_AVX2) return 0;
+		return rev ? unpack_odd_avx2<P::nbits,true>(g,n_groups,out,table_lo,table_hi) : unpack_odd_avx2<P::nbits,false>(g,n_groups,out,table_lo,table_hi);
+	}
+}
+
+template<typename P>
+std::size_t pack_simd(const char * s, std::size_t n, std::byte * out, uint8_t & classes){
+	switch(current_simd_level()){
+	case simd_AVX2: return pack_avx2<P::nbits>(alphabet_of<P>,s,n,out,classes);
+	case simd_SSE42: return pack_sse42<P::nbits>(alphabet_of<P>,s,n,out,classes);
+	default: return 0;
+	};
+}
+
+#endif
+
+}
+
+uint8_t codec::nbits(encode_type e_type){
+	switch(e_type){
+	case NUC_2BITS: return 2;
+	case NUC_3BITS: return 3;
+	case NUC_4BITS: return 4;
+	case PRO_5BITS: return 5;
+	default: return 0;
+	};
+}
+
+std::size_t codec::packed_size(encode_type e_type, std::size_t n){
+	return (n * codec::nbits(e_type) + CHAR_BIT - 1) / CHAR_BIT;
+}
+
+std::size_t codec::pack_prefix(encode_type e_type, const char * s, std::size_t n, std::byte * out, uint8_t & classes){
+	if (n==0) return 0;
+	return codec::visit(e_type,[s,n,out,&classes](auto policy){
+		using P=decltype(policy);
+		std::size_t done=0;
+#ifdef CPPBIO_X86_SIMD
+		done=pack_simd<P>(s,n,out,classes);
+#endif
+		return done + pack_scalar<P>(s + done,n - done,out + (done / 8) * P::nbits,classes);
+	});
+}
+
+void codec::pack(encode_type e_type, const char * s, std::size_t n, std::byte * out){
+	const uint8_t nbits=codec::nbits(e_type);
+	for_chunks(0,n,[e_type,s,out,nbits](std::size_t first, std::size_t n_chunk){
+		const char * c=s + first;
+		uint8_t classes=0;
+		const std::size_t done=codec::pack_prefix(e_type,c,n_chunk,out + (first / 8) * nbits,classes);
+		if (done==n_chunk) return;
+		codec::visit(e_type,[c,n_chunk,done](auto policy){
+			const alphabet & a=alphabet_of<decltype(policy)>;
+			for (std::size_t i=done; i<n_chunk; i++){
+				if (a.codes[(unsigned char) c[i]]==NO_CODE) throw_unexpected_char(a,c[i]);
+			}
+		});
+	});
+}
+
+uint8_t codec::classify(const char * s, std::size_t n){
+	std::atomic<uint8_t> classes(0);
+	for_chunks(0,n,[s,&classes](std::size_t first, std::size_t n_chunk){
+		uint8_t c=0;
+		for (std::size_t i=first; i<first + n_chunk; i++) c|=char_classes.of[(unsigned char) s[i]];
+		classes.fetch_or(c);
+	});
+	return classes.load();
+}
+
+encode_type codec::encoding_of(uint8_t classes){
+	if (classes & class_INVALID) return enc_UNDEFINED;
+	if (classes & class_PRO_5BITS) return PRO_5BITS;
+	if (classes & class_NUC_4BITS) return NUC_4BITS;
+	if (classes & class_NUC_3BITS) return NUC_3BITS;
+	if (classes & (class_NUC_2BITS | class_RNA)) return NUC_2BITS;
+	return enc_UNDEFINED;
+}
+
+void codec::check(const char * s, std::size_t n){
+	for (std::size_t i=0; i<n; i++){
+		if (char_classes.of[(unsigned char) s[i]] & class_INVALID){
+			throw std::invalid_argument(std::string("Unexpected char when parsing the biological sequence: ") + s[i]);
+		}
+	}
+}
+
+encode_type codec::pack_widening(encode_type e_type, const char * s, std::size_t n, std::byte * out, std::size_t pos, uint8_t & classes, const std::function<std::byte *(std::size_t,std::size_t)> & reserve){
+	std::size_t done=0;
+	while (true){
+		done+=codec::pack_prefix(e_type,s + done,n - done,out + ((pos + done) / 8) * codec::nbits(e_type),classes);
+		if (done==n) return e_type;
+		// the chars following the prefix choose the encoding, looking a bit ahead to widen once
+		const std::size_t n_ahead=std::min<std::size_t>(n - done,32);
+		const uint8_t ahead=codec::classify(s + done,n_ahead);
+		if (ahead & class_INVALID) codec::check(s + done,n_ahead);
+		const encode_type wider=std::max(codec::encoding_of(ahead | classes),e_type);
+		out=reserve(codec::packed_size(e_type,pos + done),codec::packed_size(wider,pos + n));
+		if (wider==PRO_5BITS && (classes & class_RNA)){
+			codec::widen(e_type,wider,out,pos,out,true);
+			codec::pack(wider,s,done,out + (pos / 8) * codec::nbits(wider));
+		}else{
+			codec::widen(e_type,wider,out,pos + done,out);
+		}
+		e_type=wider;
+	}
+}
+
+void codec::widen(encode_type from, encode_type to, const std::byte * in, std::size_t n, std::byte * out, bool rna){
+	if (n==0) return;
+	codec::visit(from,[to,in,n,out,rna](auto from_policy){
+		codec::visit(to,[in,n,out,rna](auto to_policy){
+			using F=decltype(from_policy);
+			using T=decltype(to_policy);
+			if constexpr (T::nbits < F::nbits){
+				throw std::invalid_argument("An encoding can only be widened");
+			}else{
+				// code translation through the decoded char
+				uint8_t codes[1 << F::nbits];
+				for (uint8_t k=0; k<(1 << F::nbits); k++){
+					const char c=(rna && T::e_type==PRO_5BITS && F::chars[k]=='T') ? 'U' : F::chars[k];
+					codes[k]=(c=='\0') ? 0 : alphabet_of<T>.codes[(unsigned char) c];
+					if (codes[k]==NO_CODE) throw std::invalid_argument("The encoding cannot hold every code of the widened one");
+				}
+				// from the last element to the first one, so that out may be in
+				const std::size_t n_groups=n / 8;
+				const uint8_t tail=n % 8;
+				if (tail){
+					uint64_t word=0;
+					for (uint8_t k=0; k<tail; k++) word=(word << T::nbits) | codes[codec::get_code<F>(in,n_groups * 8 + k)];
+					word<<=(64 - tail * T::nbits);
+					for (uint8_t b=0; b<(tail * T::nbits + CHAR_BIT - 1) / CHAR_BIT; b++){
+						out[n_groups * T::nbits + b]=std::byte(word >> (64 - CHAR_BIT * (b + 1)));
+					}
+				}
+				for (std::size_t j=n_groups; j-- > 0;){
+					uint64_t block=0;
+					for (uint8_t b=0; b<F::nbits; b++) block=(block << CHAR_BIT) | std::to_integer<uint64_t>(in[j * F::nbits + b]);
+					uint64_t wide=0;
+					for (uint8_t k=0; k<8; k++) wide=(wide << T::nbits) | codes[(block >> (F::nbits * (7 - k))) & ((1 << F::nbits) - 1)];
+					for (uint8_t b=0; b<T::nbits; b++) out[j * T::nbits + b]=std::byte(wide >> (CHAR_BIT * (T::nbits - 1 - b)));
+				}
+			}
+		});
+	});
+}
+
+void codec::extract(encode_type e_type, const std::byte * in, std::size_t pos, std::size_t n, std::byte * out){
+	const std::size_t bit=pos * codec::nbits(e_type);
+	const std::size_t n_bits=n * codec::nbits(e_type);
+	const std::size_t n_out=(n_bits + CHAR_BIT - 1) / CHAR_BIT;
+	if (n_out==0) return;
+	in+=bit / CHAR_BIT;
+	const uint8_t shift=bit % CHAR_BIT;
+	if (shift==0){
+		std::memcpy(out,in,n_out);
+	}else{
+		const std::size_t n_in=(shift + n_bits + CHAR_BIT - 1) / CHAR_BIT;
+		std::size_t i=0;
+		// 7 bytes per big-endian word, the last byte misses bits of the next one
+		for (; i+8<=n_out; i+=7){
+			uint64_t word;
+			std::memcpy(&word,in + i,sizeof(word));
+			word=__builtin_bswap64(__builtin_bswap64(word) << shift);
+			std::memcpy(out + i,&word,sizeof(word));
+		}
+		for (; i<n_out; i++){
+			uint8_t b=std::to_integer<uint8_t>(in[i]) << shift;
+			if (i + 1<n_in) b|=std::to_integer<uint8_t>(in[i + 1]) >> (CHAR_BIT - shift);
+			out[i]=std::byte(b);
+		}
+	}
+	if (n_bits % CHAR_BIT) out[n_out - 1]&=std::byte(0xFF << (CHAR_BIT - n_bits % CHAR_BIT));
+}
+
+void codec::reverse(encode_type e_type, const std::byte * in, std::size_t pos, std::size_t n, std::byte * out){
+	if (n==0) return;
+	codec::visit(e_type,[in,pos,n,out](auto policy){
+		using P=decltype(policy);
+		std::size_t j0=0;
+#ifdef CPPBIO_X86_SIMD
+		if constexpr (P::nbits==2 || P::nbits==4){
+			if (current_simd_level()!=simd_NONE) j0=reverse_sse42<P::nbits>(in,pos,n,out);
+		}
+#endif
+		reverse_scalar<P>(in,pos,n,j0,out);
+	});
+}
+
+void codec::unpack(encode_type e_type, const std::byte * in, std::size_t pos_all, std::size_t n_all, char * out_all, bool rev, const char * chars){
+	if (n_all==0) return;
+	// chunks of the byte array, written where they are read in the orientation asked
+	for_chunks(pos_all,n_all,[e_type,in,pos_all,n_all,out_all,rev,chars](std::size_t pos, std::size_t n){
+		char * out=out_all + (rev ? pos_all + n_all - pos - n : pos - pos_all);
+		codec::visit(e_type,[in,pos,n,out,rev,chars](auto policy){
+			using P=decltype(policy);
+			// whole groups of 8 elements start on a byte, the elements around them are read one by one
+			const std::size_t first_group=(pos + 7) / 8;
+			const std::size_t last_group=(pos + n) / 8;
+			if (first_group>=last_group){
+				for (std::size_t k=0; k<n; k++) out[k]=chars[codec::get_code<P>(in,rev ? pos + n - 1 - k : pos + k)];
+				return;
+			}
+			const std::size_t n_groups=last_group - first_group;
+			const std::size_t head=first_group * 8 - pos;
+			const std::size_t tail=pos + n - last_group * 8;
+			const std::byte * g=in + first_group * P::nbits;
+			char * out_groups=out + (rev ? tail : head);
+			for (std::size_t k=0; k<head; k++){
+				out[rev ? n - 1 - k : k]=chars[codec::get_code<P>(in,pos + k)];
+			}
+			std::size_t done=0;
+#ifdef CPPBIO_X86_SIMD
+			done=unpack_simd<P>(g,n_groups,out_groups,rev,chars);
+#endif
+			unpack_scalar<P>(g,n_groups,done,out_groups,rev,chars);
+			for (std::size_t k=0; k<tail; k++){
+				out[rev ? tail - 1 - k : head + n_groups * 8 + k]=chars[codec::get_code<P>(in,last_group * 8 + k)];
+			}
+		});
+	});
+}
+
+simd_level codec::get_simd_level(){
+	return current_simd_level();
+}
+
+simd_level codec::set_simd_level(simd_level level){
+	const simd_level max_level=detect_simd_level();
+	current_simd_level()=(level < max_level) ? level : max_level;
+	return current_simd_level();
+}
+
+unsigned int codec::get_n_threads(){
+	return current_parallelism().n_threads;
+}
+
+unsigned int codec::set_n_threads(unsigned int n){
+	const unsigned int n_threads=n ? n : std::max(1U,std::thread::hardware_concurrency());
+	current_parallelism().n_threads=n_threads;
+	return n_threads;
+}
+
+std::size_t codec::get_chunk_size(){
+	return current_parallelism().chunk_size;
+}
+
+std::size_t codec::set_chunk_size(std::size_t n){
+	const std::size_t chunk_size=std::max<std::size_t>(8,(n + 7) / 8 * 8);
+	current_parallelism().chunk_size=chunk_size;
+	return chunk_size;
+}
@@ -0,0 +1,483 @@
+/*!
+ * @file codec.hpp
+ * @brief Bulk kernels packing biological sequences into bit arrays
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef CODEC_HPP_
+#define CODEC_HPP_
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+
+namespace cppbio {
+
+	/**
+	 * @brief Definition of type `encode_type`
+	 *
+	 * Enumeration of encoding type
+	 *
+	 *  2-bits nucleotide encoding
+	 *
+	 *  A : 00
+	 *  C : 01
+	 *  G : 10
+	 *  T : 11
+	 *
+	 *  3-bits nucleotide encoding
+	 *
+	 *  A                : 000
+	 *  C                : 001
+	 *  N                : 010
+	 *  gap              : 011
+	 *  complemented gap : 100
+	 *  complemented N   : 101
+	 *  G                : 110
+	 *  T                : 111
+	 *
+	 *  4-bits nucleotide encoding
+	 *
+	 *	A       : 0000
+	 *	C       : 0001
+	 *	R       : 0010
+	 *	K       : 0011
+	 *	B       : 0100
+	 *	D       : 0101
+	 *	S or W  : 0110
+	 *	N or gap: 0111
+	 *	gap or N: 1000
+	 *	W or S  : 1001
+	 *	H       : 1010
+	 *	V       : 1011
+	 *	M       : 1100
+	 *	Y       : 1101
+	 *	G       : 1110
+	 *	T       : 1111
+	 *
+	 *  5-bits amino-acid encoding
+	 *
+	 *	A               : 00000
+	 *	B               : 00001
+	 *	C               : 00010
+	 *	E               : 00011
+	 *	F               : 00100
+	 *	G               : 00101
+	 *	H               : 00110
+	 *	I               : 00111
+	 *	K               : 01000
+	 *	L               : 01001
+	 *	M               : 01010
+	 *	N               : 01011
+	 *	P               : 01100
+	 *	Q               : 01101
+	 *	R               : 01110
+	 *	S               : 01111
+	 *	T               : 10000
+	 *	U               : 10001
+	 *	V               : 10010
+	 *	W               : 10011
+	 *	X               : 10100
+	 *	Y               : 10101
+	 *	Z               : 10110
+	 *	gap             : 10111
+	 *	1bp-frameshift	: 11000 ('!')
+	 *	2bp-frameshift	: 11001 (decoded as '!')
+	 *	stop            : 11010 ('*')
+	 *	D               : 11011
+	 *	undefined 2     : 11100
+	 *	undefined 3     : 11101
+	 *	undefined 4     : 11110
+	 *	end of sequence : 11111
+	 *
+	 */
+
+	typedef enum {
+		enc_UNDEFINED, /**<  Undefined encoding */
+		NUC_2BITS, /**<  Nucleotide encoding on 2bits */
+		NUC_3BITS, /**<  Nucleotide encoding on 3bits */
+		NUC_4BITS, /**<  Nucleotide encoding on 4bits */
+		PRO_5BITS /**<  Protein encoding on 5bits */
+	} encode_type ;
+
+	/**
+	 * @brief Definition of type `simd_level`
+	 *
+	 * Enumeration of the instruction sets the bulk kernels can use
+	 *
+	 */
+
+	typedef enum {
+		simd_NONE, /**<  Portable scalar kernels */
+		simd_SSE42, /**<  128-bits kernels (SSSE3 shuffles and SSE4.1 blends) */
+		simd_AVX2 /**<  256-bits kernels (and BMI2 bit deposits) */
+	} simd_level ;
+
+	/**
+	 * @brief Definition of type `char_class`
+	 *
+	 * Bit flags of the narrowest alphabets a char belongs to, OR-ed over a sequence to
+	 * choose its encoding
+	 *
+	 */
+
+	typedef enum : uint8_t {
+		class_NUC_2BITS=1, /**<  A, C, G or T */
+		class_RNA=2, /**<  U (encoded as T by nucleotide encodings) */
+		class_NUC_3BITS=4, /**<  N or gap */
+		class_NUC_4BITS=8, /**<  other IUPAC nucleotide codes */
+		class_PRO_5BITS=16, /**<  amino-acid only letters, stop and frameshift */
+		class_INVALID=128 /**<  chars no encoding can hold */
+	} char_class ;
+
+	/*!
+	 * @namespace cppbio::codec
+	 * @brief Bulk conversion between ASCII and packed element codes
+	 *
+	 *  The packed layout is shared by every encoding: element i occupies the bits
+	 *  [i*nbits, (i+1)*nbits[ of the byte array, most significant bit first, and the
+	 *  unused bits of the last byte are zeros.
+	 *
+	 *  Kernels process blocks of 8 elements (i.e. nbits bytes) with SSE4.2 (16 chars)
+	 *  or AVX2 (32 chars) when the CPU supports it, and a 64-bits scalar accumulator
+	 *  otherwise. All levels produce the same bytes. Unpacking translates codes with
+	 *  16-entries shuffles, from crumbs and nibbles for 2 and 4 bits, and from BMI2 deposits
+	 *  for odd widths.
+	 *
+	 *  Nucleotide encodings read U as T. The pack kernels also OR the `char_class` of the
+	 *  chars they accept, so that detecting the alphabet costs no extra pass over the input.
+	 *
+	 */
+
+namespace codec {
+
+	/*!
+	 * @struct policy
+	 * @brief Compile-time description of an encoding
+	 *
+	 *  Specializations give the width of a code and the char decoded from each code, so that
+	 *  code written against a policy gets constant shifts and masks. The first code of a
+	 *  char is the one used to encode it, codes decoded as '\0' cannot be encoded. Use `visit` to select the policy once per operation.
+	 *
+	 *  @tparam E : encoding type
+	 */
+	template<encode_type E> struct policy;
+
+	template<> struct policy<NUC_2BITS>{
+		static constexpr encode_type e_type=NUC_2BITS; /**<  encoding type */
+		static constexpr uint8_t nbits=2; /**<  number of bits of a code */
+		static constexpr char chars[]="ACGT"; /**<  char decoded from each code */
+	};
+
+	template<> struct policy<NUC_3BITS>{
+		static constexpr encode_type e_type=NUC_3BITS; /**<  encoding type */
+		static constexpr uint8_t nbits=3; /**<  number of bits of a code */
+		static constexpr char chars[]="ACN--NGT"; /**<  char decoded from each code */
+	};
+
+	template<> struct policy<NUC_4BITS>{
+		static constexpr encode_type e_type=NUC_4BITS; /**<  encoding type */
+		static constexpr uint8_t nbits=4; /**<  number of bits of a code */
+		static constexpr char chars[]="ACRKBDSN-WHVMYGT"; /**<  char decoded from each code */
+	};
+
+	template<> struct policy<PRO_5BITS>{
+		static constexpr encode_type e_type=PRO_5BITS; /**<  encoding type */
+		static constexpr uint8_t nbits=5; /**<  number of bits of a code */
+		static constexpr char chars[]="ABCEFGHIKLMNPQRSTUVWXYZ-!!*D\0\0\0\0"; /**<  char decoded from each code ('\0' for codes without char) */
+	};
+
+	/*!
+	 *  @brief Call a functor with the policy of an encoding
+	 *
+	 *  This is the single runtime dispatch of an operation: `f` receives a default-constructed
+	 *  `policy<E>` and is instantiated for every encoding.
+	 *
+	 *  @param e_type : encoding type
+	 *  @param f : generic functor taking a policy
+	 *  @return what `f` returns
+	 *  @throw std::invalid_argument if no policy exists for `e_type`
+	 */
+	template<typename F>
+	decltype(auto) visit(encode_type e_type, F && f){
+		switch(e_type){
+		case NUC_2BITS: return f(policy<NUC_2BITS>{});
+		case NUC_3BITS: return f(policy<NUC_3BITS>{});
+		case NUC_4BITS: return f(policy<NUC_4BITS>{});
+		case PRO_5BITS: return f(policy<PRO_5BITS>{});
+		default: throw std::invalid_argument("No codec is available for this encoding");
+		};
+	}
+
+	/*!
+	 *  @brief Get the code of an element
+	 *
+	 *  Only the bytes holding the element are read.
+	 *
+	 *  @tparam P : encoding policy
+	 *  @param in : packed byte array
+	 *  @param i : index of the element
+	 *  @return code of the element
+	 */
+	template<typename P>
+	inline uint8_t get_code(const std::byte * in, std::size_t i){
+		const std::size_t bit=i * P::nbits;
+		const uint8_t offset=bit % CHAR_BIT;
+		uint16_t word=std::to_integer<uint16_t>(in[bit / CHAR_BIT]) << CHAR_BIT;
+		if (offset + P::nbits > CHAR_BIT) word|=std::to_integer<uint16_t>(in[bit / CHAR_BIT + 1]);
+		return (word >> (2 * CHAR_BIT - offset - P::nbits)) & ((1 << P::nbits) - 1);
+	}
+
+	/*!
+	 *  @brief Complement a nucleotide
+	 *
+	 *  IUPAC letters are complemented, S, W, N and gap are their own complement.
+	 *
+	 *  @param c : upper case char
+	 *  @return complemented char
+	 */
+	constexpr char complement(char c){
+		switch(c){
+		case 'A': return 'T';
+		case 'T': return 'A';
+		case 'C': return 'G';
+		case 'G': return 'C';
+		case 'R': return 'Y';
+		case 'Y': return 'R';
+		case 'K': return 'M';
+		case 'M': return 'K';
+		case 'B': return 'V';
+		case 'V': return 'B';
+		case 'D': return 'H';
+		case 'H': return 'D';
+		default: return c;
+		};
+	}
+
+	/*!
+	 *  @brief Number of bits used to store an element
+	 *
+	 *  @param e_type : encoding type
+	 *  @return number of bits (0 for enc_UNDEFINED)
+	 */
+	uint8_t nbits(encode_type e_type);
+
+	/*!
+	 *  @brief Number of bytes needed to pack elements
+	 *
+	 *  @param e_type : encoding type
+	 *  @param n : number of elements
+	 *  @return number of bytes
+	 */
+	std::size_t packed_size(encode_type e_type, std::size_t n);
+
+	/*!
+	 *  @brief Pack ASCII chars into a byte array
+	 *
+	 *  Characters are case insensitive. `out` must hold `packed_size(e_type,n)` bytes,
+	 *  all of them are written.
+	 *
+	 *  @param e_type : encoding type
+	 *  @param s : chars to encode
+	 *  @param n : number of chars
+	 *  @param out : byte array to write
+	 *  @throw std::invalid_argument if a char cannot be encoded with `e_type`
+	 */
+	void pack(encode_type e_type, const char * s, std::size_t n, std::byte * out);
+
+	/*!
+	 *  @brief Pack the longest encodable prefix of ASCII chars
+	 *
+	 *  Packing stops at the first block of 8 chars (or at the tail) holding a char that
+	 *  `e_type` cannot encode, so that the packed prefix always ends on a byte boundary
+	 *  and the remaining chars can be packed at `out + n_done / 8 * nbits`.
+	 *
+	 *  @param e_type : encoding type
+	 *  @param s : chars to encode
+	 *  @param n : number of chars
+	 *  @param out : byte array to write (`packed_size(e_type,n)` bytes)
+	 *  @param classes : OR-ed with the `char_class` of the packed chars
+	 *  @return number of chars packed (n_done), a multiple of 8 unless it is n
+	 *  @throw std::invalid_argument if `e_type` has no codec
+	 */
+	std::size_t pack_prefix(encode_type e_type, const char * s, std::size_t n, std::byte * out, uint8_t & classes);
+
+	/*!
+	 *  @brief OR the `char_class` of chars
+	 *
+	 *  @param s : chars
+	 *  @param n : number of chars
+	 *  @return OR-ed classes
+	 */
+	uint8_t classify(const char * s, std::size_t n);
+
+	/*!
+	 *  @brief Narrowest encoding holding every class
+	 *
+	 *  @param classes : OR-ed `char_class`
+	 *  @return encoding type (enc_UNDEFINED if class_INVALID is set or no class is)
+	 */
+	encode_type encoding_of(uint8_t classes);
+
+	/*!
+	 *  @brief Check that every char can be encoded
+	 *
+	 *  @param s : chars
+	 *  @param n : number of chars
+	 *  @throw std::invalid_argument naming the first char no encoding can hold
+	 */
+	void check(const char * s, std::size_t n);
+
+	/*!
+	 *  @brief Pack ASCII chars with the narrowest encoding holding them, in a single pass
+	 *
+	 *  Chars are packed with `e_type` until one requires a wider encoding. The elements
+	 *  packed (the `pos` ones already in `out` included) are then widened in place and
+	 *  packing goes on. An RNA prefix widened to PRO_5BITS is packed again from its chars,
+	 *  U and T sharing a nucleotide code but not an amino-acid one (elements before `pos`,
+	 *  whose chars are gone, get U if `classes` holds class_RNA).
+	 *
+	 *  @param e_type : encoding to start with
+	 *  @param s : chars to encode
+	 *  @param n : number of chars
+	 *  @param out : byte array holding `pos` elements of `e_type`, with room for `pos + n` of them
+	 *  @param pos : number of elements in `out`, a multiple of 8
+	 *  @param classes : `char_class` of the elements in `out`, OR-ed with the ones of the chars
+	 *  @param reserve : called before widening with the number of bytes used and the number
+	 *  of bytes needed, returns a byte array holding the used bytes with room for the needed ones
+	 *  @return encoding of the `pos + n` elements
+	 *  @throw std::invalid_argument if a char cannot be encoded
+	 */
+	encode_type pack_widening(encode_type e_type, const char * s, std::size_t n, std::byte * out, std::size_t pos, uint8_t & classes, const std::function<std::byte *(std::size_t,std::size_t)> & reserve);
+
+	/*!
+	 *  @brief Re-encode packed elements with a wider encoding
+	 *
+	 *  Each code is mapped to the code of the same char (U for the T code of RNA widened to
+	 *  PRO_5BITS, the two being distinct amino-acids). Elements are written from the
+	 *  last one to the first one, so that `out` may be `in` if it holds
+	 *  `packed_size(to,n)` bytes.
+	 *
+	 *  @param from : encoding of `in`
+	 *  @param to : encoding of `out`
+	 *  @param in : packed byte array
+	 *  @param n : number of elements
+	 *  @param out : byte array to write
+	 *  @param rna : whether the T code of a nucleotide encoding is read as U
+	 *  @throw std::invalid_argument if `to` is narrower than `from` or misses one of its chars
+	 */
+	void widen(encode_type from, encode_type to, const std::byte * in, std::size_t n, std::byte * out, bool rna=false);
+
+	/*!
+	 *  @brief Copy packed elements to the beginning of a byte array
+	 *
+	 *  Elements are shifted so that the first one starts at the first bit of `out`, unused
+	 *  bits of the last byte are zeros.
+	 *
+	 *  @param e_type : encoding type
+	 *  @param in : packed byte array
+	 *  @param pos : index of the first element to copy
+	 *  @param n : number of elements to copy
+	 *  @param out : byte array to write (`packed_size(e_type,n)` bytes)
+	 */
+	void extract(encode_type e_type, const std::byte * in, std::size_t pos, std::size_t n, std::byte * out);
+
+	/*!
+	 *  @brief Copy packed elements in reverse order to the beginning of a byte array
+	 *
+	 *  The last element is written at the first bit of `out`, unused bits of the last byte
+	 *  are zeros. 2 and 4 bits are reversed 16 bytes at a time with byte shuffles and
+	 *  nibble or crumb swaps.
+	 *
+	 *  @param e_type : encoding type
+	 *  @param in : packed byte array
+	 *  @param pos : index of the first element to copy
+	 *  @param n : number of elements to copy
+	 *  @param out : byte array to write (`packed_size(e_type,n)` bytes, not overlapping `in`)
+	 */
+	void reverse(encode_type e_type, const std::byte * in, std::size_t pos, std::size_t n, std::byte * out);
+
+	/*!
+	 *  @brief Unpack elements of a byte array into ASCII chars
+	 *
+	 *  Codes are translated with `chars`, so that complement or any other per-code mapping
+	 *  costs nothing more than a plain decoding. `out` must hold `n` chars, no terminating
+	 *  null char is written.
+	 *
+	 *  @param e_type : encoding type
+	 *  @param in : packed byte array
+	 *  @param pos : index of the first element to unpack
+	 *  @param n : number of elements to unpack
+	 *  @param out : chars to write
+	 *  @param rev : whether the elements are written from the last one to the first one
+	 *  @param chars : char of each code (2^nbits entries)
+	 */
+	void unpack(encode_type e_type, const std::byte * in, std::size_t pos, std::size_t n, char * out, bool rev, const char * chars);
+
+	/*!
+	 *  @brief Get the instruction set used by the kernels
+	 *
+	 *  Defaults to the best level supported by the running CPU.
+	 *
+	 *  @return current level
+	 */
+	simd_level get_simd_level();
+
+	/*!
+	 *  @brief Set the instruction set used by the kernels
+	 *
+	 *  The requested level is capped to what the running CPU supports.
+	 *
+	 *  @param level : requested level
+	 *  @return level actually set
+	 */
+	simd_level set_simd_level(simd_level level);
+
+	/*!
+	 *  @brief Get the number of threads of the bulk kernels
+	 *
+	 *  `pack`, `classify` and `unpack` split more than `get_chunk_size()` elements into
+	 *  chunks processed by this number of threads. Defaults to the number of cores.
+	 *  It bounds the threads of all the calls in flight: concurrent callers share the
+	 *  n - 1 extra threads and run the chunks left on their own thread.
+	 *
+	 *  @return current number of threads
+	 */
+	unsigned int get_n_threads();
+
+	/*!
+	 *  @brief Set the number of threads of the bulk kernels
+	 *
+	 *  The output does not depend on it, 1 runs every kernel on the calling thread.
+	 *  Safe to call while other threads run kernels.
+	 *
+	 *  @param n : number of threads (0 for the number of cores)
+	 *  @return number of threads actually set
+	 */
+	unsigned int set_n_threads(unsigned int n);
+
+	/*!
+	 *  @brief Get the number of elements of a chunk
+	 *
+	 *  Chunks start at the multiples of this size in the byte array, so that each one
+	 *  starts on a byte whatever the encoding. Defaults to 2^22 elements.
+	 *
+	 *  @return current chunk size
+	 */
+	std::size_t get_chunk_size();
+
+	/*!
+	 *  @brief Set the number of elements of a chunk
+	 *
+	 *  @param n : requested size, rounded up to a multiple of 8
+	 *  @return chunk size actually set
+	 */
+	std::size_t set_chunk_size(std::size_t n);
+
+}
+}
+
+#endif /* CODEC_HPP_ */
@@ -0,0 +1,317 @@
+/*
+ * distance.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <distance.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(CPPBIO_NO_SIMD)
+#define CPPBIO_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace cppbio;
+
+// Declaration and Definition of objects used only within this scope
+
+namespace {
+
+/*
+ * Words of whole groups of 8 elements: 32 crumbs, 16 triplets or nibbles, 8 quintuplets,
+ * the first element in the most significant field.
+ */
+template<typename P>
+struct words_of {
+	static constexpr std::size_t n_groups=64 / (8 * P::nbits); /**<  groups of a word */
+	static constexpr std::size_t bytes=n_groups * P::nbits; /**<  packed bytes of a word */
+	static constexpr std::size_t elements=8 * n_groups; /**<  elements of a word */
+	static constexpr uint64_t low=[]{
+		uint64_t l=0;
+		for (std::size_t j=0;j<elements;j++) l|=uint64_t(1) << (8 * bytes - (j + 1) * P::nbits);
+		return(l);
+	}(); /**<  lowest bit of every field */
+
+	// word of the packed bytes p, of which only len are readable
+	static uint64_t load(const std::byte * p,std::size_t len){
+		uint64_t w=0;
+		for (std::size_t k=0;k<bytes;k++) w=(w << CHAR_BIT) | (k<len ? std::to_integer<uint64_t>(p[k]) : 0);
+		return(w);
+	}
+	// OR the bits of each field into its lowest one
+	static uint64_t fold(uint64_t x){
+		uint64_t y=x;
+		for (uint8_t s=1;s<P::nbits;s++) y|=x >> s;
+		return(y & low);
+	}
+	// lowest bits of the first r fields (0 < r <= elements)
+	static uint64_t first_fields(std::size_t r){
+		return(low & ~((uint64_t(1) << (8 * bytes - r * P::nbits)) - 1));
+	}
+	// word j of n packed elements starting at p, the fields after the last element being zeros
+	static uint64_t word(const std::byte * p,std::size_t n,std::size_t j){
+		const std::size_t n_bytes=(n * P::nbits + CHAR_BIT - 1) / CHAR_BIT;
+		const uint64_t fields=(n - j * elements<elements) ? first_fields(n - j * elements) : low;
+		return(load(p + j * bytes,n_bytes - j * bytes) & (fields * ((uint64_t(1) << P::nbits) - 1)));
+	}
+};
+
+/*
+ * Packed codes of the elements of a seq as read, from the first bit of data. Only a seq
+ * read forward, starting on a byte and of the requested encoding and complement is not
+ * copied.
+ */
+struct packed_view {
+	const std::byte * data;
+	std::vector<std::byte> own;
+};
+
+template<IsAnyOf T_uint>
+packed_view view_of(const seq<T_uint> & s,encode_type e,bool comp){
+	const std::size_t n=s.size();
+	const encode_type from=s.get_e_type();
+	const std::size_t bit=std::size_t(s.get_offset()) * codec::nbits(from);
+	packed_view v;
+	if (n==0 || (from==e && s.get_is_comp()==comp && !s.get_is_rev() && bit % CHAR_BIT==0)){
+		v.data=s.get_data() + bit / CHAR_BIT;
+		return(v);
+	};
+	v.own.resize(codec::packed_size(e,n));
+	if (s.get_is_comp()!=comp && from!=NUC_2BITS){
+		// the complement of a code is a code of another char: through the chars
+		char table[32]={};
+		codec::visit(from,[&table](auto policy){
+			using P=decltype(policy);
+			for (std::size_t code=0;code<(std::size_t(1) << P::nbits);code++) table[code]=codec::complement(P::chars[code]);
+		});
+		std::string chars(n,'\0');
+		codec::unpack(from,s.get_data(),s.get_offset(),n,chars.data(),s.get_is_rev(),table);
+		codec::pack(e,chars.data(),n,v.own.data());
+	}else{
+		std::vector<std::byte> packed(codec::packed_size(from,n));
+		if (s.get_is_rev()){
+			codec::reverse(from,s.get_data(),s.get_offset(),n,packed.data());
+		}else{
+			codec::extract(from,s.get_data(),s.get_offset(),n,packed.data());
+		};
+		if (s.get_is_comp()!=comp){
+			// 2 bits: the complement of a code is its negation
+			for (std::byte & b: packed) b=~b;
+			if ((2 * n) % CHAR_BIT) packed.back()&=std::byte(0xFF << (CHAR_BIT - (2 * n) % CHAR_BIT));
+		};
+		if (from==e){
+			std::copy(packed.begin(),packed.end(),v.own.begin());
+		}else{
+			codec::widen(from,e,packed.data(),n,v.own.data());
+		};
+	};
+	v.data=v.own.data();
+	return(v);
+}
+
+template<typename P>
+uint64_t count_mismatches(const std::byte * a,const std::byte * b,std::size_t n,uint64_t limit){
+	using W=words_of<P>;
+	const std::size_t n_bytes=(n * P::nbits + CHAR_BIT - 1) / CHAR_BIT;
+	uint64_t r=0;
+	for (std::size_t i=0;i<n;i+=W::elements){
+		const std::size_t first=i / 8 * P::nbits;
+		const std::size_t len=std::min(W::bytes,n_bytes - first);
+		uint64_t x;
+		if (W::bytes==8 && len==8){
+			uint64_t wa,wb;
+			std::memcpy(&wa,a + first,8);
+			std::memcpy(&wb,b + first,8);
+			x=__builtin_bswap64(wa ^ wb);
+		}else{
+			x=W::load(a + first,len) ^ W::load(b + first,len);
+		};
+		const uint64_t fields=(n - i<W::elements) ? W::first_fields(n - i) : W::low;
+		r+=std::popcount(W::fold(x) & fields);
+		if (r>limit) return(r);
+	};
+	return(r);
+}
+
+template<IsAnyOf T_uint>
+uint64_t compare(const seq<T_uint> & a,const seq<T_uint> & b,uint64_t limit){
+	if (a.size()!=b.size()){
+		throw std::invalid_argument("Sequences of different sizes cannot be compared element by element");
+	};
+	if ((a.get_e_type()==PRO_5BITS)!=(b.get_e_type()==PRO_5BITS)){
+		throw std::invalid_argument("A protein cannot be compared to a nucleotide sequence");
+	};
+	if (a.size()==0) return(0);
+	const encode_type e=std::max(a.get_e_type(),b.get_e_type());
+	const packed_view va=view_of(a,e,a.get_is_comp());
+	const packed_view vb=view_of(b,e,a.get_is_comp());
+	return(codec::visit(e,[&va,&vb,&a,limit](auto policy){
+		return(count_mismatches<decltype(policy)>(va.data,vb.data,a.size(),limit));
+	}));
+}
+
+#ifdef CPPBIO_X86_SIMD
+
+/*
+ * Mismatches of a query with 4 barcodes at a time, popcount of 64-bits lanes with nibble
+ * lookups summed by sad.
+ */
+template<typename P>
+__attribute__((target("avx2")))
+std::size_t hamming_avx2(const uint64_t * words,std::size_t n,std::size_t n_words,const uint64_t * query,const uint64_t * forced,uint32_t * out){
+	using W=words_of<P>;
+	const __m256i lut=_mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+	const __m256i m0F=_mm256_set1_epi8(0x0F);
+	const __m256i low=_mm256_set1_epi64x(W::low);
+	std::size_t i=0;
+	for (;i + 4<=n;i+=4){
+		__m256i acc=_mm256_setzero_si256();
+		for (std::size_t j=0;j<n_words;j++){
+			const __m256i x=_mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (words + j * n + i)),_mm256_set1_epi64x(query[j]));
+			__m256i y=x;
+			for (uint8_t s=1;s<P::nbits;s++) y=_mm256_or_si256(y,_mm256_srli_epi64(x,s));
+			y=_mm256_or_si256(_mm256_and_si256(y,low),_mm256_set1_epi64x(forced[j]));
+			const __m256i c=_mm256_add_epi8(_mm256_shuffle_epi8(lut,_mm256_and_si256(y,m0F)),_mm256_shuffle_epi8(lut,_mm256_and_si256(_mm256_srli_epi16(y,4),m0F)));
+			acc=_mm256_add_epi64(acc,_mm256_sad_epu8(c,_mm256_setzero_si256()));
+		};
+		alignas(32) uint64_t counts[4];
+		_mm256_store_si256((__m256i *) counts,acc);
+		for (std::size_t k=0;k<4;k++) out[i + k]=counts[k];
+	};
+	return(i);
+}
+
+#endif
+
+}
+
+// PAIRWISE
+template<IsAnyOf T_uint>
+uint64_t cppbio::hamming(const seq<T_uint> & a,const seq<T_uint> & b){
+	SPDLOG_DEBUG("hamming");
+	return(compare(a,b,UINT64_MAX));
+};
+
+template<IsAnyOf T_uint>
+uint64_t cppbio::mismatches_up_to(const seq<T_uint> & a,const seq<T_uint> & b,uint64_t k){
+	SPDLOG_DEBUG("mismatches_up_to");
+	const uint64_t r=compare(a,b,k);
+	return(r>k ? k + 1 : r);
+};
+
+template uint64_t cppbio::hamming<uint8_t>(const seq<uint8_t> &,const seq<uint8_t> &);
+template uint64_t cppbio::hamming<uint16_t>(const seq<uint16_t> &,const seq<uint16_t> &);
+template uint64_t cppbio::hamming<uint32_t>(const seq<uint32_t> &,const seq<uint32_t> &);
+template uint64_t cppbio::hamming<uint64_t>(const seq<uint64_t> &,const seq<uint64_t> &);
+template uint64_t cppbio::mismatches_up_to<uint8_t>(const seq<uint8_t> &,const seq<uint8_t> &,uint64_t);
+template uint64_t cppbio::mismatches_up_to<uint16_t>(const seq<uint16_t> &,const seq<uint16_t> &,uint64_t);
+template uint64_t cppbio::mismatches_up_to<uint32_t>(const seq<uint32_t> &,const seq<uint32_t> &,uint64_t);
+template uint64_t cppbio::mismatches_up_to<uint64_t>(const seq<uint64_t> &,const seq<uint64_t> &,uint64_t);
+
+// BARCODE SET
+template<IsAnyOf T_uint>
+barcode_set<T_uint>::barcode_set(const std::vector<seq<T_uint>> & barcodes){
+	SPDLOG_DEBUG("barcode_set::barcode_set");
+	this->n=barcodes.size();
+	this->length=barcodes.empty() ? 0 : barcodes[0].size();
+	this->e_type=NUC_2BITS;
+	for (const seq<T_uint> & s: barcodes){
+		if (s.size()!=this->length){
+			throw std::invalid_argument("Barcodes must have the same size");
+		};
+		if (s.get_e_type()==PRO_5BITS){
+			throw std::invalid_argument("Barcodes must be nucleotide sequences");
+		};
+		this->e_type=std::max(this->e_type,s.get_e_type());
+	};
+	codec::visit(this->e_type,[this,&barcodes](auto policy){
+		using W=words_of<decltype(policy)>;
+		this->n_words=(this->length + W::elements - 1) / W::elements;
+		this->words.resize(this->n_words * this->n);
+		for (std::size_t i=0;i<this->n;i++){
+			const packed_view v=view_of(barcodes[i],this->e_type,false);
+			for (std::size_t j=0;j<this->n_words;j++) this->words[j * this->n + i]=W::word(v.data,this->length,j);
+		};
+	});
+};
+
+template<IsAnyOf T_uint>
+std::vector<uint32_t> barcode_set<T_uint>::hamming(const seq<T_uint> & query) const{
+	SPDLOG_DEBUG("barcode_set::hamming");
+	std::vector<uint64_t> forced;
+	const std::vector<uint64_t> q=this->query_words(query,forced);
+	std::vector<uint32_t> r(this->n,0);
+	codec::visit(this->e_type,[this,&q,&forced,&r](auto policy){
+		using P=decltype(policy);
+		using W=words_of<P>;
+		std::size_t i=0;
+#ifdef CPPBIO_X86_SIMD
+		if (codec::get_simd_level()==simd_AVX2) i=hamming_avx2<P>(this->words.data(),this->n,this->n_words,q.data(),forced.data(),r.data());
+#endif
+		for (;i<this->n;i++){
+			for (std::size_t j=0;j<this->n_words;j++) r[i]+=std::popcount(W::fold(this->words[j * this->n + i] ^ q[j]) | forced[j]);
+		};
+	});
+	return(r);
+};
+
+template<IsAnyOf T_uint>
+std::vector<std::size_t> barcode_set<T_uint>::within(const seq<T_uint> & query,uint32_t k) const{
+	SPDLOG_DEBUG("barcode_set::within");
+	const std::vector<uint32_t> d=this->hamming(query);
+	std::vector<std::size_t> r;
+	for (std::size_t i=0;i<d.size();i++){
+		if (d[i]<=k) r.push_back(i);
+	};
+	return(r);
+};
+
+// INTERNAL FUNCTIONS
+template<IsAnyOf T_uint>
+std::vector<uint64_t> barcode_set<T_uint>::query_words(const seq<T_uint> & query,std::vector<uint64_t> & forced) const{
+	if (query.size()!=this->length){
+		throw std::invalid_argument("The query must have the size of the barcodes");
+	};
+	if (query.get_e_type()==PRO_5BITS){
+		throw std::invalid_argument("The query must be a nucleotide sequence");
+	};
+	std::vector<uint64_t> r(this->n_words);
+	forced.assign(this->n_words,0);
+	if (this->length==0) return(r);
+	if (query.get_e_type()<=this->e_type){
+		const packed_view v=view_of(query,this->e_type,false);
+		const std::byte * data=v.data;
+		codec::visit(this->e_type,[this,data,&r](auto policy){
+			using W=words_of<decltype(policy)>;
+			for (std::size_t j=0;j<this->n_words;j++) r[j]=W::word(data,this->length,j);
+		});
+		return(r);
+	};
+	// chars the barcodes cannot hold (an N in ACGT barcodes) mismatch every barcode: they
+	// are packed as A, and the lowest bit of their field is set in the forced words
+	std::string chars=query.get_string();
+	std::string marks(this->length,'A');
+	for (std::size_t i=0;i<this->length;i++){
+		if (codec::encoding_of(codec::classify(chars.data() + i,1))>this->e_type){
+			chars[i]='A';
+			marks[i]='T';
+		};
+	};
+	std::vector<std::byte> packed(codec::packed_size(this->e_type,this->length));
+	std::vector<std::byte> packed_marks(packed.size());
+	codec::pack(this->e_type,chars.data(),this->length,packed.data());
+	// T is the code of highest bits in the nucleotide encodings, A the null one
+	codec::pack(this->e_type,marks.data(),this->length,packed_marks.data());
+	codec::visit(this->e_type,[this,&packed,&packed_marks,&r,&forced](auto policy){
+		using W=words_of<decltype(policy)>;
+		for (std::size_t j=0;j<this->n_words;j++){
+			r[j]=W::word(packed.data(),this->length,j);
+			forced[j]=W::fold(W::word(packed_marks.data(),this->length,j));
+		};
+	});
+	return(r);
+};
@@ -0,0 +1,119 @@
+/*!
+ * @file distance.hpp
+ * @brief Mismatch counting between encoded sequences
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef DISTANCE_HPP_
+#define DISTANCE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "seq.hpp"
+
+namespace cppbio {
+
+	/*!
+	 *  @brief Count the mismatches between two seqs
+	 *
+	 *  Seqs are compared as read (orientation and complement applied), element by element:
+	 *  IUPAC codes are chars like the others. Codes are compared on whole 64-bits words
+	 *  (XOR, OR of the bits of each field into its lowest one, popcount). A seq read in
+	 *  reverse, a region that does not start on a byte, or a seq of a narrower encoding is
+	 *  first copied into a packed buffer by the bulk kernels.
+	 *
+	 *  @param a : first seq
+	 *  @param b : second seq
+	 *  @return number of elements that differ
+	 *  @throw std::invalid_argument if the seqs have different sizes or are not both proteins or both nucleotides
+	 */
+	template<IsAnyOf T_uint>
+	uint64_t hamming(const seq<T_uint> & a,const seq<T_uint> & b);
+
+	/*!
+	 *  @brief Count the mismatches between two seqs up to a limit
+	 *
+	 *  Same as hamming, but words are no longer compared once the limit is exceeded.
+	 *
+	 *  @param a : first seq
+	 *  @param b : second seq
+	 *  @param k : highest number of mismatches of interest
+	 *  @return number of elements that differ if at most k, k + 1 otherwise
+	 *  @throw std::invalid_argument if the seqs have different sizes or are not both proteins or both nucleotides
+	 */
+	template<IsAnyOf T_uint>
+	uint64_t mismatches_up_to(const seq<T_uint> & a,const seq<T_uint> & b,uint64_t k);
+
+	/*!
+	 * @class barcode_set
+	 * @brief A contiguous array of packed barcodes compared to queries
+	 *
+	 *  Barcodes share their length and encoding (the widest of the seqs given). They are
+	 *  stored column-wise: the i-th 64-bits word of every barcode, then the next ones, so
+	 *  that a query word is compared to 4 barcodes at a time with AVX2 (or one at a time
+	 *  with the scalar kernel, see codec::set_simd_level).
+	 *
+	 *  @tparam T_uint : index type of the seqs
+	 */
+	template<IsAnyOf T_uint>
+	class barcode_set{
+		public:
+			/*!
+			 *  @brief Constructor
+			 *
+			 *  @param barcodes : nucleotide seqs of the same size, read as they are (orientation and complement applied)
+			 *  @throw std::invalid_argument if the seqs have different sizes or a seq is a protein
+			 */
+			explicit barcode_set(const std::vector<seq<T_uint>> & barcodes);
+			/*!
+			 *  @brief Get the number of barcodes
+			 *
+			 *	@return number of barcodes
+			 */
+			std::size_t size() const{ return(this->n); };
+			/*!
+			 *  @brief Count the mismatches with every barcode
+			 *
+			 *  Elements of the query the encoding of the barcodes cannot hold (an N when the
+			 *  barcodes are made of A, C, G and T) mismatch every barcode.
+			 *
+			 *  @param query : nucleotide seq of the size of the barcodes
+			 *	@return number of mismatches with each barcode
+			 *  @throw std::invalid_argument if the query has another size or is a protein
+			 */
+			std::vector<uint32_t> hamming(const seq<T_uint> & query) const;
+			/*!
+			 *  @brief Find the barcodes close to a query
+			 *
+			 *  @param query : nucleotide seq of the size of the barcodes
+			 *  @param k : highest number of mismatches
+			 *	@return indexes of the barcodes with at most k mismatches, increasing
+			 *  @throw std::invalid_argument if the query has another size or is a protein
+			 */
+			std::vector<std::size_t> within(const seq<T_uint> & query,uint32_t k) const;
+
+		private:
+
+			// ATTRIBUTES
+
+			std::size_t n; /**<  number of barcodes */
+			std::size_t length; /**<  number of elements of a barcode */
+			encode_type e_type; /**<  encoding of the barcodes */
+			std::size_t n_words; /**<  number of words of a barcode */
+			std::vector<uint64_t> words; /**<  word j of barcode i at j * n + i */
+
+			// INTERNAL FUNCTIONS
+
+			std::vector<uint64_t> query_words(const seq<T_uint> & query,std::vector<uint64_t> & forced) const;
+	};
+
+	template class barcode_set<uint8_t>;
+	template class barcode_set<uint16_t>;
+	template class barcode_set<uint32_t>;
+	template class barcode_set<uint64_t>;
+}
+
+#endif /* DISTANCE_HPP_ */
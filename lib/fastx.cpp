@@ -0,0 +1,278 @@
+/*
+ * fastx.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <fastx.hpp>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(CPPBIO_NO_SIMD)
+#define CPPBIO_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace cppbio;
+
+// Declaration and Definition of objects used only within this scope
+
+namespace {
+
+const char * find_char_scalar(const char * p, const char * e, char c){
+	const void * r=std::memchr(p,c,e - p);
+	return r ? static_cast<const char *>(r) : e;
+}
+
+#ifdef CPPBIO_X86_SIMD
+
+__attribute__((target("sse4.2")))
+const char * find_char_sse42(const char * p, const char * e, char c){
+	const __m128i v=_mm_set1_epi8(c);
+	for (; p+16<=e; p+=16){
+		const uint32_t m=_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) p),v));
+		if (m) return p + __builtin_ctz(m);
+	}
+	return find_char_scalar(p,e,c);
+}
+
+__attribute__((target("avx2")))
+const char * find_char_avx2(const char * p, const char * e, char c){
+	const __m256i v=_mm256_set1_epi8(c);
+	for (; p+32<=e; p+=32){
+		const uint32_t m=_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) p),v));
+		if (m) return p + __builtin_ctz(m);
+	}
+	return find_char_scalar(p,e,c);
+}
+
+#endif
+
+// First occurrence of c in [p,e[, or e
+const char * find_char(const char * p, const char * e, char c){
+#ifdef CPPBIO_X86_SIMD
+	switch(codec::get_simd_level()){
+	case simd_AVX2: return find_char_avx2(p,e,c);
+	case simd_SSE42: return find_char_sse42(p,e,c);
+	default: break;
+	};
+#endif
+	return find_char_scalar(p,e,c);
+}
+
+// End of the line content, without the '\r' of a "\r\n" line break
+const char * strip_cr(const char * b, const char * e){
+	return (e > b && e[-1]=='\r') ? e - 1 : e;
+}
+
+/*
+ * Field made of one or more lines: a single line stays a view on the input,
+ * further lines are concatenated into a buffer of the reader.
+ */
+struct field {
+	std::string & buffer;
+	const char * first=nullptr;
+	std::size_t length=0;
+	unsigned int n_lines=0;
+
+	void add(const char * b, const char * e){
+		if (n_lines==0){
+			first=b;
+			length=e - b;
+		}else{
+			if (n_lines==1) buffer.assign(first,length);
+			buffer.append(b,e);
+			length=buffer.size();
+		}
+		n_lines++;
+	}
+
+	std::string_view view() const{
+		return (n_lines > 1) ? std::string_view(buffer) : std::string_view(first,length);
+	}
+};
+
+void set_header(fastx_record & r, const char * b, const char * e){
+	const char * blank=b;
+	while (blank<e && *blank!=' ' && *blank!='\t') blank++;
+	r.name=std::string_view(b,blank - b);
+	r.comment=(blank<e) ? std::string_view(blank + 1,e - blank - 1) : std::string_view();
+}
+
+}
+
+// CONSTRUCTORS
+fastx_reader::fastx_reader(const std::string & path,std::size_t block_size){
+	this->is_mapped=false;
+	this->is_eof=false;
+	this->map_size=0;
+	this->format=fmt_UNDEFINED;
+	this->fd=(path=="-") ? STDIN_FILENO : ::open(path.c_str(),O_RDONLY);
+	if (this->fd<0){
+		throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+	};
+	struct stat st;
+	if (fstat(this->fd,&st)==0 && S_ISREG(st.st_mode) && st.st_size>0){
+		void * m=mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,this->fd,0);
+		if (m!=MAP_FAILED){
+			madvise(m,st.st_size,MADV_SEQUENTIAL);
+			this->is_mapped=true;
+			this->is_eof=true;
+			this->map_size=st.st_size;
+			this->begin=static_cast<const char *>(m);
+			this->end=this->begin + this->map_size;
+		};
+	};
+	if (!this->is_mapped){
+		this->block.resize(block_size ? block_size : 1);
+		this->begin=this->end=this->block.data();
+	};
+	this->pos=this->begin;
+	if (this->skip_blank_lines()){
+		switch(*this->pos){
+			case '>': this->format=FASTA; break;
+			case '@': this->format=FASTQ; break;
+			default:
+				this->release();
+				throw std::invalid_argument( "Input is neither FASTA ('>') nor FASTQ ('@'): " + path );
+		};
+	};
+};
+
+fastx_reader::~fastx_reader(){
+	this->release();
+};
+
+// GETTERS
+fastx_format fastx_reader::get_format() const{
+	return(this->format);
+};
+
+bool fastx_reader::next(fastx_record & r){
+	while (this->skip_blank_lines()){
+		if (this->parse(r)) return(true);
+		this->refill();
+	};
+	return(false);
+};
+
+// INTERNAL FUNCTIONS
+void fastx_reader::release(){
+	if (this->is_mapped){
+		munmap(const_cast<char *>(this->begin),this->map_size);
+		this->is_mapped=false;
+	};
+	if (this->fd>=0 && this->fd!=STDIN_FILENO) ::close(this->fd);
+	this->fd=-1;
+};
+
+bool fastx_reader::refill(){
+	if (this->is_eof) return(false);
+	const std::size_t kept=this->end - this->pos;
+	if (this->pos==this->block.data() && kept==this->block.size()){
+		// a record is larger than the buffer
+		this->block.resize(2 * this->block.size());
+	}else{
+		std::memmove(this->block.data(),this->pos,kept);
+	};
+	std::size_t filled=kept;
+	while (filled<this->block.size()){
+		const ssize_t n=::read(this->fd,this->block.data() + filled,this->block.size() - filled);
+		if (n<0){
+			if (errno==EINTR) continue;
+			throw std::runtime_error(std::string("Cannot read the input: ") + std::strerror(errno));
+		};
+		if (n==0){
+			this->is_eof=true;
+			break;
+		};
+		filled+=n;
+	};
+	this->begin=this->pos=this->block.data();
+	this->end=this->begin + filled;
+	return(true);
+};
+
+bool fastx_reader::skip_blank_lines(){
+	while (true){
+		while (this->pos<this->end && (*this->pos=='\n' || *this->pos=='\r')) this->pos++;
+		if (this->pos<this->end) return(true);
+		if (!this->refill()) return(false);
+	};
+};
+
+bool fastx_reader::parse(fastx_record & r){
+	switch(this->format){
+		case FASTA: return(this->parse_fasta(r));
+		case FASTQ: return(this->parse_fastq(r));
+		default: throw std::invalid_argument( "Unexpected record in an empty input" );
+	};
+};
+
+// The parsers return false when the record is not entirely in [pos,end[ and more input may come
+
+bool fastx_reader::parse_fasta(fastx_record & r){
+	if (*this->pos!='>') throw std::invalid_argument( "FASTA record should start with '>'" );
+	const char * nl=find_char(this->pos,this->end,'\n');
+	if (nl==this->end && !this->is_eof) return(false);
+	set_header(r,this->pos + 1,strip_cr(this->pos + 1,nl));
+	field s {this->sequence};
+	const char * p=(nl<this->end) ? nl + 1 : this->end;
+	while (p<this->end && *p!='>'){
+		nl=find_char(p,this->end,'\n');
+		if (nl==this->end && !this->is_eof) return(false);
+		if (nl + 1==this->end && !this->is_eof) return(false); // the next line may start a record or not
+		s.add(p,strip_cr(p,nl));
+		p=(nl<this->end) ? nl + 1 : this->end;
+	};
+	r.sequence=s.view();
+	r.quality=std::string_view();
+	this->pos=p;
+	return(true);
+};
+
+bool fastx_reader::parse_fastq(fastx_record & r){
+	if (*this->pos!='@') throw std::invalid_argument( "FASTQ record should start with '@'" );
+	const char * nl=find_char(this->pos,this->end,'\n');
+	if (nl==this->end && !this->is_eof) return(false);
+	set_header(r,this->pos + 1,strip_cr(this->pos + 1,nl));
+	field s {this->sequence};
+	const char * p=(nl<this->end) ? nl + 1 : this->end;
+	while (true){
+		if (p==this->end){
+			if (!this->is_eof) return(false);
+			throw std::invalid_argument( "FASTQ record without '+' line: " + std::string(r.name) );
+		};
+		nl=find_char(p,this->end,'\n');
+		if (nl==this->end && !this->is_eof) return(false);
+		const bool is_plus=(*p=='+');
+		if (!is_plus) s.add(p,strip_cr(p,nl));
+		p=(nl<this->end) ? nl + 1 : this->end;
+		if (is_plus) break;
+	};
+	// quality lines may start with '@' or '+', they are delimited by the sequence length
+	field q {this->quality};
+	while (q.length<s.length){
+		if (p==this->end){
+			if (!this->is_eof) return(false);
+			break;
+		};
+		nl=find_char(p,this->end,'\n');
+		if (nl==this->end && !this->is_eof) return(false);
+		q.add(p,strip_cr(p,nl));
+		p=(nl<this->end) ? nl + 1 : this->end;
+	};
+	if (q.length!=s.length){
+		throw std::invalid_argument( "FASTQ quality and sequence lengths differ: " + std::string(r.name) );
+	};
+	r.sequence=s.view();
+	r.quality=q.view();
+	this->pos=p;
+	return(true);
+};
@@ -0,0 +1,131 @@
+/*!
+ * @file fastx.hpp
+ * @brief Streaming reader of FASTA and FASTQ files
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef FASTX_HPP_
+#define FASTX_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "codec.hpp"
+
+namespace cppbio {
+
+	/**
+	 * @brief Definition of type `fastx_format`
+	 *
+	 * Enumeration of sequence file formats
+	 *
+	 */
+
+	typedef enum {
+		fmt_UNDEFINED, /**<  Undefined format (empty input) */
+		FASTA, /**<  '>' header line followed by sequence lines */
+		FASTQ /**<  '@' header line, sequence lines, '+' line and quality lines */
+	} fastx_format ;
+
+	/*!
+	 * @struct fastx_record
+	 * @brief Views on the fields of a record
+	 *
+	 *  Views point either into the input (single-line fields) or into buffers of the
+	 *  reader reused from one record to the next (multi-line fields). They are valid until
+	 *  the next call to `fastx_reader::next`.
+	 *
+	 */
+	struct fastx_record {
+		std::string_view name; /**<  header up to the first blank, without '>' or '@' */
+		std::string_view comment; /**<  header after the first blank */
+		std::string_view sequence; /**<  sequence chars without line breaks */
+		std::string_view quality; /**<  quality chars without line breaks (empty for FASTA) */
+	};
+
+	/*!
+	 * @class fastx_reader
+	 * @brief A class reading FASTA or FASTQ records
+	 *
+	 *  Regular files are memory-mapped, other inputs (pipes, "-" for stdin) are read in large
+	 *  blocks. Line breaks are located with SIMD scans (at the level of `codec::get_simd_level`)
+	 *  and single-line sequences are given as views on the input, so that they can be encoded
+	 *  without any copy:
+	 *
+	 *  @code
+	 *  fastx_reader reader(path);
+	 *  fastx_record r;
+	 *  while (reader.next(r)){
+	 *      seq<uint32_t> s(r.sequence.data(),r.sequence.size());
+	 *  }
+	 *  @endcode
+	 *
+	 *  The format is given by the first char of the input, "\r\n" line breaks are accepted.
+	 *
+	 */
+	class fastx_reader{
+		public:
+			/*!
+			 *  @brief Path constructor
+			 *
+			 *  @param path : path of the file to read, "-" for stdin
+			 *  @param block_size : initial size of the buffer when the input cannot be mapped
+			 *  @throw std::runtime_error if the input cannot be read
+			 *  @throw std::invalid_argument if the input starts with neither '>' nor '@'
+			 */
+			explicit fastx_reader(const std::string & path,std::size_t block_size=1 << 24);
+			/*!
+			 *  @brief Destructor
+			 *
+			 *  Unmap or close the input.
+			 *
+			 */
+			~fastx_reader();
+			fastx_reader(const fastx_reader &)=delete;
+			fastx_reader & operator = (const fastx_reader &)=delete;
+			/*!
+			 *  @brief Read the next record
+			 *
+			 *  @param r : record whose views are set
+			 *  @return false when the input is exhausted
+			 *  @throw std::invalid_argument if the record is malformed
+			 */
+			bool next(fastx_record & r);
+			/*!
+			 *  @brief Get the format of the input
+			 *
+			 *	@return the format (fmt_UNDEFINED for an empty input)
+			 */
+			fastx_format get_format() const;
+
+		private:
+
+			// ATTRIBUTES
+
+			int fd; /**<  file descriptor of the input */
+			bool is_mapped; /**<  whether the input is memory-mapped or read in blocks */
+			bool is_eof; /**<  whether the whole input is in [begin,end[ */
+			const char * begin; /**<  first char of the input available */
+			const char * end; /**<  past the last char of the input available */
+			const char * pos; /**<  first char of the next record */
+			std::size_t map_size; /**<  size of the mapping */
+			std::vector<char> block; /**<  buffer of the input read in blocks */
+			std::string sequence; /**<  buffer of multi-line sequences */
+			std::string quality; /**<  buffer of multi-line qualities */
+			fastx_format format; /**<  format of the input */
+
+			// INTERNAL FUNCTIONS
+
+			void release();
+			bool refill();
+			bool skip_blank_lines();
+			bool parse(fastx_record & r);
+			bool parse_fasta(fastx_record & r);
+			bool parse_fastq(fastx_record & r);
+
+	};
+}
+
+#endif /* FASTX_HPP_ */
@@ -0,0 +1,56 @@
+/*
+ * kmer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <kmer.hpp>
+
+using namespace cppbio;
+
+// CONSTRUCTORS
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+kmers<T_uint,T_kmer>::kmers(const seq<T_uint> & s,uint8_t in_k){
+	SPDLOG_DEBUG("kmers::kmers");
+	if (in_k==0 || in_k>4 * sizeof(T_kmer)){
+		throw std::invalid_argument("k must be between 1 and 4 times the size of the k-mer code type");
+	};
+	if (s.get_e_type()==PRO_5BITS){
+		throw std::invalid_argument("k-mers are computed on nucleotide sequences only");
+	};
+	this->data=s.get_data();
+	this->first=s.get_offset();
+	this->n=s.size();
+	this->n_bytes=codec::packed_size(s.get_e_type(),this->first + this->n);
+	this->nbits=codec::nbits(s.get_e_type());
+	this->rev=s.get_is_rev();
+	this->k=in_k;
+	for (uint8_t & b: this->base) b=4;
+	if (this->n==0) return;
+	// element code -> char (complement applied) -> 2-bits code
+	const bool comp=s.get_is_comp();
+	codec::visit(s.get_e_type(),[this,comp](auto policy){
+		using P=decltype(policy);
+		for (uint8_t code=0;code<(1 << P::nbits);code++){
+			const char c=comp ? codec::complement(P::chars[code]) : P::chars[code];
+			switch(c){
+				case 'A': this->base[code]=0; break;
+				case 'C': this->base[code]=1; break;
+				case 'G': this->base[code]=2; break;
+				case 'T': this->base[code]=3; break;
+				default: break;
+			};
+		};
+	});
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+typename kmers<T_uint,T_kmer>::iterator kmers<T_uint,T_kmer>::begin() const{
+	return(iterator(this,this->n<this->k));
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+typename kmers<T_uint,T_kmer>::iterator kmers<T_uint,T_kmer>::end() const{
+	return(iterator(this,true));
+};
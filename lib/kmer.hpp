@@ -0,0 +1,236 @@
+/*!
+ * @file kmer.hpp
+ * @brief Rolling k-mer codes over encoded nucleotide sequences
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef KMER_HPP_
+#define KMER_HPP_
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include "seq.hpp"
+
+namespace cppbio {
+
+	typedef unsigned __int128 uint128_t; /**<  k-mer code for k up to 64 */
+
+	template<typename T_kmer>
+	concept IsKmerCode = (std::same_as<T_kmer, uint32_t> || std::same_as<T_kmer, uint64_t> || std::same_as<T_kmer, uint128_t>);
+
+	/*!
+	 * @struct kmer
+	 * @brief A k-mer and its position
+	 *
+	 *  Codes use 2 bits per base (A=00, C=01, G=10, T=11) with the first base in the most
+	 *  significant bits, as in the NUC_2BITS encoding.
+	 *
+	 *  @tparam T_kmer : unsigned type holding 2*k bits
+	 */
+	template<IsKmerCode T_kmer>
+	struct kmer {
+		std::size_t pos; /**<  index of the first base in the seq */
+		T_kmer forward; /**<  code of the k-mer */
+		T_kmer reverse; /**<  code of its reverse complement */
+
+		/*!
+		 *  @brief Canonical code
+		 *
+		 *	@return The lowest of the codes of the k-mer and of its reverse complement
+		 */
+		T_kmer canonical() const{ return(forward < reverse ? forward : reverse); };
+	};
+
+	/*!
+	 *  @brief Hash a k-mer code
+	 *
+	 *  The 64-bits finalizer of MurmurHash3: a bijection spreading every input bit over
+	 *  the whole word, so that any range of bits can pick a partition or a slot.
+	 *
+	 *  @param x : k-mer code
+	 *  @return hash of the code
+	 */
+	constexpr uint64_t kmer_hash(uint64_t x){
+		x^=x >> 33;
+		x*=0xff51afd7ed558ccdULL;
+		x^=x >> 33;
+		x*=0xc4ceb9fe1a85ec53ULL;
+		x^=x >> 33;
+		return(x);
+	}
+	constexpr uint64_t kmer_hash(uint32_t x){ return(kmer_hash(uint64_t(x))); }
+	constexpr uint64_t kmer_hash(uint128_t x){ return(kmer_hash(uint64_t(x) ^ kmer_hash(uint64_t(x >> 64)))); }
+
+	/*!
+	 *  @brief Reverse complement a k-mer code
+	 *
+	 *  @param code : code of a k-mer
+	 *  @param k : number of bases of the k-mer
+	 *  @return code of its reverse complement
+	 */
+	template<IsKmerCode T_kmer>
+	constexpr T_kmer kmer_reverse_complement(T_kmer code,uint8_t k){
+		T_kmer r=0;
+		for (uint8_t i=0;i<k;i++){
+			r=(r << 2) | (3 - (code & 3));
+			code>>=2;
+		};
+		return(r);
+	}
+
+	/*!
+	 * @class kmers
+	 * @brief A range of the k-mers of a nucleotide seq
+	 *
+	 *  The k-mers are those of the seq as read (orientation and complement applied). Each
+	 *  step shifts one base into the forward and reverse complement codes. Bases are taken
+	 *  from the packed byte array one group of 8 (nbits bytes) at a time. With NUC_3BITS and
+	 *  NUC_4BITS, the windows holding any base other than A, C, G or T are skipped.
+	 *
+	 *  @tparam T_uint : index type of the seq
+	 *  @tparam T_kmer : unsigned type of the codes, k must be at most 4 * sizeof(T_kmer)
+	 */
+	template<IsAnyOf T_uint, IsKmerCode T_kmer=uint64_t>
+	class kmers{
+		public:
+			class iterator;
+
+			/*!
+			 *  @brief Constructor
+			 *
+			 *  The range does not copy the seq: it is valid as long as the seq is.
+			 *
+			 *  @param s : nucleotide seq
+			 *  @param k : number of bases of a k-mer
+			 *  @throw std::invalid_argument if k is 0 or too large for T_kmer, or if s is a protein
+			 */
+			kmers(const seq<T_uint> & s,uint8_t k);
+			/*!
+			 *  @brief Iterator on the first k-mer
+			 *
+			 *	@return An input iterator
+			 */
+			iterator begin() const;
+			/*!
+			 *  @brief Iterator past the last k-mer
+			 *
+			 *	@return An input iterator
+			 */
+			iterator end() const;
+
+		private:
+
+			// ATTRIBUTES
+
+			const std::byte * data; /**<  byte array of the seq */
+			std::size_t first; /**<  index of the first element in the byte array */
+			std::size_t n; /**<  number of elements */
+			std::size_t n_bytes; /**<  number of bytes readable */
+			uint8_t nbits; /**<  number of bits of an element */
+			bool rev; /**<  whether the seq is read in reverse */
+			uint8_t k; /**<  number of bases of a k-mer */
+			uint8_t base[16]; /**<  2-bits code of each element code (complement applied), 4 if not A, C, G or T */
+	};
+
+	/*!
+	 * @class kmers::iterator
+	 * @brief An input iterator on k-mers
+	 *
+	 */
+	template<IsAnyOf T_uint, IsKmerCode T_kmer>
+	class kmers<T_uint,T_kmer>::iterator{
+		public:
+			using iterator_category=std::input_iterator_tag;
+			using value_type=kmer<T_kmer>;
+			using difference_type=std::ptrdiff_t;
+			using pointer=const kmer<T_kmer> *;
+			using reference=const kmer<T_kmer> &;
+
+			iterator()=default;
+
+			const kmer<T_kmer> & operator * () const{ return(this->current); };
+			const kmer<T_kmer> * operator -> () const{ return(&this->current); };
+			iterator & operator ++ (){ this->advance(); return(*this); };
+			iterator operator ++ (int){ iterator r(*this); this->advance(); return(r); };
+
+			bool operator == (const iterator & o) const{
+				return(this->done==o.done && (this->done || this->current.pos==o.current.pos));
+			};
+
+		private:
+
+			friend class kmers;
+
+			iterator(const kmers * in_range,bool in_done):range(in_range),done(in_done){
+				if (!this->done){
+					const std::size_t bits=2 * this->range->k;
+					this->mask=(bits==sizeof(T_kmer) * CHAR_BIT) ? ~T_kmer(0) : (T_kmer(1) << bits) - 1;
+					this->advance();
+				};
+			};
+
+			// Code of the element i of the seq as read, from the cached group of 8 elements
+			uint8_t base(std::size_t i){
+				const kmers & r=*this->range;
+				const std::size_t j=r.rev ? r.first + r.n - 1 - i : r.first + i;
+				const std::size_t g=j / 8;
+				if (g!=this->group){
+					// the last group may be partial
+					const std::size_t b=g * r.nbits;
+					this->word=0;
+					for (std::size_t k=0;k<r.nbits;k++){
+						this->word=(this->word << CHAR_BIT) | (b + k<r.n_bytes ? std::to_integer<uint64_t>(r.data[b + k]) : 0);
+					};
+					this->group=g;
+				};
+				return(r.base[(this->word >> (r.nbits * (7 - j % 8))) & ((1 << r.nbits) - 1)]);
+			};
+
+			void advance(){
+				const kmers & r=*this->range;
+				const uint8_t shift=2 * (r.k - 1);
+				while (this->next<r.n){
+					const uint8_t c=this->base(this->next++);
+					if (c>3){
+						this->valid=0;
+						continue;
+					};
+					this->current.forward=((this->current.forward << 2) | c) & this->mask;
+					this->current.reverse=(this->current.reverse >> 2) | (T_kmer(3 - c) << shift);
+					if (++this->valid>=r.k){
+						this->current.pos=this->next - r.k;
+						return;
+					};
+				};
+				this->done=true;
+			};
+
+			const kmers * range=nullptr; /**<  range iterated */
+			bool done=true; /**<  whether the iterator is past the last k-mer */
+			kmer<T_kmer> current {0,0,0}; /**<  current k-mer */
+			T_kmer mask=0; /**<  2*k low bits */
+			std::size_t next=0; /**<  index of the next element to shift in */
+			std::size_t valid=0; /**<  number of A, C, G or T elements ending the window */
+			std::size_t group=SIZE_MAX; /**<  index of the group held by word */
+			uint64_t word=0; /**<  codes of the group, first one in the most significant bits */
+	};
+
+	template class kmers<uint8_t,uint32_t>;
+	template class kmers<uint16_t,uint32_t>;
+	template class kmers<uint32_t,uint32_t>;
+	template class kmers<uint64_t,uint32_t>;
+	template class kmers<uint8_t,uint64_t>;
+	template class kmers<uint16_t,uint64_t>;
+	template class kmers<uint32_t,uint64_t>;
+	template class kmers<uint64_t,uint64_t>;
+	template class kmers<uint8_t,uint128_t>;
+	template class kmers<uint16_t,uint128_t>;
+	template class kmers<uint32_t,uint128_t>;
+	template class kmers<uint64_t,uint128_t>;
+}
+
+#endif /* KMER_HPP_ */
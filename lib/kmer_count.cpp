@@ -0,0 +1,264 @@
+/*
+ * kmer_count.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <kmer_count.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+using namespace cppbio;
+
+// Declaration and Definition of objects used only within this scope
+
+namespace {
+
+/*
+ * Run f(t) for t in [0,n[ on n threads, the calling one included, and rethrow the
+ * first exception raised by any of them once they are all joined.
+ */
+template<typename F>
+void run_threads(unsigned int n,F && f){
+	std::vector<std::exception_ptr> errors(n);
+	std::vector<std::thread> threads;
+	auto guarded=[&f,&errors](unsigned int t){
+		try {
+			f(t);
+		} catch (...){
+			errors[t]=std::current_exception();
+		};
+	};
+	for (unsigned int t=1;t<n;t++) threads.emplace_back(guarded,t);
+	guarded(0);
+	for (std::thread & th: threads) th.join();
+	for (const std::exception_ptr & e: errors){
+		if (e) std::rethrow_exception(e);
+	};
+}
+
+}
+
+// CONSTRUCTORS
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+kmer_counter<T_uint,T_kmer>::kmer_counter(uint8_t in_k,unsigned int in_n_threads,const std::string & in_spill_dir,std::size_t in_buffer_size){
+	SPDLOG_DEBUG("kmer_counter::kmer_counter");
+	if (in_k==0 || in_k>4 * sizeof(T_kmer)){
+		throw std::invalid_argument("k must be between 1 and 4 times the size of the k-mer code type");
+	};
+	this->k=in_k;
+	this->n_threads=in_n_threads ? in_n_threads : std::max(1U,std::thread::hardware_concurrency());
+	// a few partitions per thread, so that merging is balanced
+	this->partition_bits=0;
+	while ((std::size_t(1) << this->partition_bits) < 4 * std::size_t(this->n_threads)) this->partition_bits++;
+	this->tables.resize(std::size_t(1) << this->partition_bits);
+	// the budget is shared by the buffers of every thread and partition
+	this->buffer_size=std::max<std::size_t>(in_buffer_size / (this->n_threads * this->tables.size()),1);
+	if (!in_spill_dir.empty()){
+		std::string path=in_spill_dir + "/cppbio_kmers_XXXXXX";
+		if (mkdtemp(path.data())==nullptr){
+			throw std::runtime_error("Cannot create a directory in " + in_spill_dir + ": " + std::strerror(errno));
+		};
+		this->spill_dir=path;
+	};
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+kmer_counter<T_uint,T_kmer>::~kmer_counter(){
+	SPDLOG_DEBUG("kmer_counter::~kmer_counter");
+	if (this->spill_dir.empty()) return;
+	this->remove_spills();
+	rmdir(this->spill_dir.c_str());
+};
+
+// MODIFIERS
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+void kmer_counter<T_uint,T_kmer>::add(const std::vector<seq<T_uint>> & seqs){
+	SPDLOG_DEBUG("kmer_counter::add " + std::to_string(seqs.size()) + " seqs");
+	for (const seq<T_uint> & s: seqs){
+		if (s.get_e_type()==PRO_5BITS){
+			throw std::invalid_argument("k-mers are computed on nucleotide sequences only");
+		};
+	};
+	const std::size_t n_partitions=this->tables.size();
+	const bool spilling=!this->spill_dir.empty();
+	// buffers[t * n_partitions + p] holds the codes of partition p found by thread t
+	std::vector<std::vector<T_kmer>> buffers(this->n_threads * n_partitions);
+	// in memory, a full buffer is merged into the table of its partition
+	std::vector<std::mutex> locks(spilling ? 0 : n_partitions);
+
+	try {
+		std::atomic<std::size_t> next_seq(0);
+		run_threads(this->n_threads,[&](unsigned int t){
+			std::vector<T_kmer> * own=buffers.data() + t * n_partitions;
+			for (std::size_t i=next_seq++;i<seqs.size();i=next_seq++){
+				for (const kmer<T_kmer> & m: kmers<T_uint,T_kmer>(seqs[i],this->k)){
+					const T_kmer code=m.canonical();
+					const std::size_t p=this->partition(kmer_hash(code));
+					std::vector<T_kmer> & b=own[p];
+					b.push_back(code);
+					if (b.size()<this->buffer_size) continue;
+					if (spilling){
+						this->spill(p,t,b);
+					}else{
+						std::lock_guard<std::mutex> lock(locks[p]);
+						this->merge(this->tables[p],b.data(),b.size());
+						b.clear();
+					};
+				};
+			};
+		});
+
+		std::atomic<std::size_t> next_partition(0);
+		run_threads(this->n_threads,[&](unsigned int){
+			std::vector<T_kmer> chunk;
+			for (std::size_t p=next_partition++;p<n_partitions;p=next_partition++){
+				for (unsigned int t=0;t<this->n_threads;t++){
+					if (spilling){
+						const std::string path=this->spill_path(p,t);
+						std::ifstream in(path,std::ios::binary);
+						if (in){
+							chunk.resize(this->buffer_size);
+							while (in.read(reinterpret_cast<char *>(chunk.data()),chunk.size() * sizeof(T_kmer)) || in.gcount()){
+								this->merge(this->tables[p],chunk.data(),in.gcount() / sizeof(T_kmer));
+							};
+							if (!in.eof()){
+								throw std::runtime_error("Cannot read " + path);
+							};
+							in.close();
+							std::remove(path.c_str());
+						};
+					};
+					std::vector<T_kmer> & b=buffers[t * n_partitions + p];
+					this->merge(this->tables[p],b.data(),b.size());
+					std::vector<T_kmer>().swap(b);
+				};
+			};
+		});
+	} catch (...){
+		// the next call must not merge the codes spilled by this one
+		this->remove_spills();
+		throw;
+	};
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+void kmer_counter<T_uint,T_kmer>::add(const seq<T_uint> & s){
+	this->add(std::vector<seq<T_uint>>(1,s));
+};
+
+// GETTERS
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+uint64_t kmer_counter<T_uint,T_kmer>::count(T_kmer code) const{
+	const T_kmer rc=kmer_reverse_complement(code,this->k);
+	if (rc<code) code=rc;
+	const uint64_t h=kmer_hash(code);
+	const table & t=this->tables[this->partition(h)];
+	if (t.n==0) return(0);
+	const std::size_t mask=t.keys.size() - 1;
+	for (std::size_t i=h & mask;t.counts[i];i=(i + 1) & mask){
+		if (t.keys[i]==code) return(t.counts[i]);
+	};
+	return(0);
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+uint64_t kmer_counter<T_uint,T_kmer>::count(const std::string & s) const{
+	if (s.size()!=this->k) return(0);
+	T_kmer code=0;
+	for (char c: s){
+		uint8_t b;
+		switch(c){
+			case 'A': case 'a': b=0; break;
+			case 'C': case 'c': b=1; break;
+			case 'G': case 'g': b=2; break;
+			case 'T': case 't': case 'U': case 'u': b=3; break;
+			default: return(0);
+		};
+		code=(code << 2) | b;
+	};
+	return(this->count(code));
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+std::size_t kmer_counter<T_uint,T_kmer>::size() const{
+	std::size_t n=0;
+	for (const table & t: this->tables) n+=t.n;
+	return(n);
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+std::map<uint64_t,uint64_t> kmer_counter<T_uint,T_kmer>::histogram() const{
+	std::map<uint64_t,uint64_t> h;
+	this->for_each([&h](T_kmer,uint64_t c){ h[c]++; });
+	return(h);
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+void kmer_counter<T_uint,T_kmer>::write_histogram(std::ostream & out) const{
+	for (const auto & [c,n]: this->histogram()) out << c << '\t' << n << '\n';
+};
+
+// INTERNAL FUNCTIONS
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+std::string kmer_counter<T_uint,T_kmer>::spill_path(std::size_t p,unsigned int t) const{
+	return(this->spill_dir + "/" + std::to_string(p) + "_" + std::to_string(t) + ".bin");
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+void kmer_counter<T_uint,T_kmer>::spill(std::size_t p,unsigned int t,std::vector<T_kmer> & buffer) const{
+	const std::string path=this->spill_path(p,t);
+	std::ofstream out(path,std::ios::binary | std::ios::app);
+	out.write(reinterpret_cast<const char *>(buffer.data()),buffer.size() * sizeof(T_kmer));
+	out.close();
+	if (!out){
+		throw std::runtime_error("Cannot write " + path + ": " + std::strerror(errno));
+	};
+	buffer.clear();
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+void kmer_counter<T_uint,T_kmer>::remove_spills() const{
+	if (this->spill_dir.empty()) return;
+	for (std::size_t p=0;p<this->tables.size();p++){
+		for (unsigned int t=0;t<this->n_threads;t++) std::remove(this->spill_path(p,t).c_str());
+	};
+};
+
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+void kmer_counter<T_uint,T_kmer>::merge(table & t,const T_kmer * codes,std::size_t n) const{
+	for (std::size_t j=0;j<n;j++){
+		// keep the load at most 1/2 so that probes stay short
+		if (2 * (t.n + 1) > t.keys.size()){
+			table grown;
+			grown.keys.resize(std::max<std::size_t>(16,2 * t.keys.size()));
+			grown.counts.resize(grown.keys.size(),0);
+			const std::size_t mask=grown.keys.size() - 1;
+			for (std::size_t i=0;i<t.keys.size();i++){
+				if (t.counts[i]==0) continue;
+				std::size_t s=kmer_hash(t.keys[i]) & mask;
+				while (grown.counts[s]) s=(s + 1) & mask;
+				grown.keys[s]=t.keys[i];
+				grown.counts[s]=t.counts[i];
+			};
+			grown.n=t.n;
+			t=std::move(grown);
+		};
+		const std::size_t mask=t.keys.size() - 1;
+		std::size_t s=kmer_hash(codes[j]) & mask;
+		while (t.counts[s] && t.keys[s]!=codes[j]) s=(s + 1) & mask;
+		if (t.counts[s]==0){
+			t.keys[s]=codes[j];
+			t.n++;
+		};
+		t.counts[s]++;
+	};
+};
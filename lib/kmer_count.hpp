@@ -0,0 +1,186 @@
+/*!
+ * @file kmer_count.hpp
+ * @brief Multi-threaded counting of canonical k-mers
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef KMER_COUNT_HPP_
+#define KMER_COUNT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "kmer.hpp"
+
+namespace cppbio {
+
+	/*!
+	 * @class kmer_counter
+	 * @brief Count the canonical k-mers of collections of seq
+	 *
+	 *  k-mers are partitioned by the high bits of their hash. Counting a collection is done
+	 *  in two phases:
+	 *
+	 *  - threads take seqs in turn and append the canonical codes to their own buffer of
+	 *    each partition;
+	 *  - threads take partitions in turn and merge the buffers of every thread into the
+	 *    open-addressing table of the partition, that no other thread touches.
+	 *
+	 *  The codes pending in the buffers are bounded by `buffer_size` whatever the size of
+	 *  the collection: it is split evenly among the threads x partitions buffers, and a
+	 *  full buffer is emptied during the first phase. In memory, it is merged into the
+	 *  table of its partition under the lock of the partition. In spilling mode, it is
+	 *  appended to a file of its partition, so that threads never wait on each other,
+	 *  and the files are merged during the second phase. Either way the tables of the
+	 *  distinct k-mers stay in memory: spilling moves the pending codes to disk, it does
+	 *  not bound the memory used by the counts.
+	 *
+	 *  Windows holding a base other than A, C, G or T are not counted.
+	 *
+	 *  @tparam T_uint : index type of the seqs
+	 *  @tparam T_kmer : unsigned type of the codes, k must be at most 4 * sizeof(T_kmer)
+	 */
+	template<IsAnyOf T_uint, IsKmerCode T_kmer=uint64_t>
+	class kmer_counter{
+		public:
+			/*!
+			 *  @brief Constructor
+			 *
+			 *  @param k : number of bases of a k-mer
+			 *  @param n_threads : number of threads (0 for the number of cores)
+			 *  @param spill_dir : directory of the spilled partitions (empty to count in memory)
+			 *  @param buffer_size : number of codes buffered by all the threads, split among
+			 *  their buffers of each partition
+			 *  @throw std::invalid_argument if k is 0 or too large for T_kmer
+			 *  @throw std::runtime_error if the spilling directory cannot be created
+			 */
+			explicit kmer_counter(uint8_t k,unsigned int n_threads=0,const std::string & spill_dir="",std::size_t buffer_size=1 << 22);
+			/*!
+			 *  @brief Destructor
+			 *
+			 *  Remove the spilled files.
+			 *
+			 */
+			~kmer_counter();
+			kmer_counter(const kmer_counter &)=delete;
+			kmer_counter & operator = (const kmer_counter &)=delete;
+			/*!
+			 *  @brief Count the k-mers of seqs
+			 *
+			 *  Counts are added to those of the previous calls. If the call fails, the counts
+			 *  hold part of the k-mers of seqs, and its spilled files are removed.
+			 *
+			 *  @param seqs : nucleotide seqs
+			 *  @throw std::invalid_argument if a seq is a protein
+			 *  @throw std::runtime_error if a spilled partition cannot be written or read
+			 */
+			void add(const std::vector<seq<T_uint>> & seqs);
+			/*!
+			 *  @brief Count the k-mers of a seq
+			 *
+			 *  @param s : nucleotide seq
+			 *  @throw std::invalid_argument if the seq is a protein
+			 */
+			void add(const seq<T_uint> & s);
+			/*!
+			 *  @brief Get the count of a k-mer
+			 *
+			 *  @param code : code of the k-mer or of its reverse complement
+			 *	@return number of occurrences of the k-mer and of its reverse complement
+			 */
+			uint64_t count(T_kmer code) const;
+			/*!
+			 *  @brief Get the count of a k-mer
+			 *
+			 *  @param s : the k bases of the k-mer
+			 *	@return number of occurrences of the k-mer and of its reverse complement, 0 if s
+			 *	is not made of k A, C, G or T
+			 */
+			uint64_t count(const std::string & s) const;
+			/*!
+			 *  @brief Get the number of distinct canonical k-mers
+			 *
+			 *	@return number of k-mers counted at least once
+			 */
+			std::size_t size() const;
+			/*!
+			 *  @brief Get the histogram of the counts
+			 *
+			 *	@return number of distinct canonical k-mers for each count
+			 */
+			std::map<uint64_t,uint64_t> histogram() const;
+			/*!
+			 *  @brief Write the histogram of the counts
+			 *
+			 *  One line per count: the count and the number of k-mers, tab separated.
+			 *
+			 *  @param out : stream to write
+			 */
+			void write_histogram(std::ostream & out) const;
+			/*!
+			 *  @brief Call a functor on every canonical k-mer
+			 *
+			 *  @param f : functor taking the canonical code and its count
+			 */
+			template<typename F>
+			void for_each(F && f) const{
+				for (const table & t: this->tables){
+					for (std::size_t i=0;i<t.keys.size();i++){
+						if (t.counts[i]) f(t.keys[i],t.counts[i]);
+					};
+				};
+			};
+
+		private:
+
+			/*!
+			 * @struct table
+			 * @brief Open-addressing table of a partition
+			 *
+			 *  Linear probing on the low bits of the hash, a count of 0 marks an empty slot.
+			 *
+			 */
+			struct table {
+				std::vector<T_kmer> keys; /**<  canonical codes */
+				std::vector<uint64_t> counts; /**<  count of each code */
+				std::size_t n=0; /**<  number of codes held */
+			};
+
+			// ATTRIBUTES
+
+			uint8_t k; /**<  number of bases of a k-mer */
+			unsigned int n_threads; /**<  number of threads */
+			uint8_t partition_bits; /**<  number of high bits of the hash giving the partition */
+			std::vector<table> tables; /**<  table of each partition */
+			std::string spill_dir; /**<  directory of the spilled partitions, empty if counting in memory */
+			std::size_t buffer_size; /**<  number of codes a thread buffers per partition before merging or spilling */
+
+			// INTERNAL FUNCTIONS
+
+			std::size_t partition(uint64_t h) const{ return(this->partition_bits ? h >> (64 - this->partition_bits) : 0); };
+			std::string spill_path(std::size_t p,unsigned int t) const;
+			void spill(std::size_t p,unsigned int t,std::vector<T_kmer> & buffer) const;
+			void remove_spills() const;
+			void merge(table & t,const T_kmer * codes,std::size_t n) const;
+	};
+
+	template class kmer_counter<uint8_t,uint32_t>;
+	template class kmer_counter<uint16_t,uint32_t>;
+	template class kmer_counter<uint32_t,uint32_t>;
+	template class kmer_counter<uint64_t,uint32_t>;
+	template class kmer_counter<uint8_t,uint64_t>;
+	template class kmer_counter<uint16_t,uint64_t>;
+	template class kmer_counter<uint32_t,uint64_t>;
+	template class kmer_counter<uint64_t,uint64_t>;
+	template class kmer_counter<uint8_t,uint128_t>;
+	template class kmer_counter<uint16_t,uint128_t>;
+	template class kmer_counter<uint32_t,uint128_t>;
+	template class kmer_counter<uint64_t,uint128_t>;
+}
+
+#endif /* KMER_COUNT_HPP_ */
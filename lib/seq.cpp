@@ -6,85 +6,282 @@
  */
 
 #include <seq.hpp>
-
-// constant of byte-typed binary code often used
-const std::byte b00 {0b00};
-const std::byte b01 {0b01};
-const std::byte b10 {0b10};
-const std::byte b11 {0b11};
-
-const std::byte b000 {0b000};
-const std::byte b001 {0b001};
-const std::byte b010 {0b010};
-const std::byte b011 {0b011};
-const std::byte b100 {0b100};
-const std::byte b101 {0b101};
-const std::byte b110 {0b110};
-const std::byte b111 {0b111};
-
-const std::byte b0000 {0b0000};
-const std::byte b0001 {0b0001};
-const std::byte b0010 {0b0010};
-const std::byte b0011 {0b0011};
-const std::byte b0100 {0b0100};
-const std::byte b0101 {0b0101};
-const std::byte b0110 {0b0110};
-const std::byte b0111 {0b0111};
-const std::byte b1000 {0b1000};
-const std::byte b1001 {0b1001};
-const std::byte b1010 {0b1010};
-const std::byte b1011 {0b1011};
-const std::byte b1100 {0b1100};
-const std::byte b1101 {0b1101};
-const std::byte b1110 {0b1110};
-const std::byte b1111 {0b1111};
-
-const std::byte b11111111 {0b11111111};
-const std::byte b00000001 {0b00000001};
-const std::byte b00000011 {0b00000011};
-const std::byte b00000111 {0b00000111};
-const std::byte b00001111 {0b00001111};
-
-// MACRO to be used within seq::set_encode_parameters only
-
-#define PARSE_STR_ENCODING(XA,XB,XC,XD,XE,XF) {\
-switch(toupper(c)){\
-	case 'A':case 'T':case 'C':case 'G':\
-		XA break;\
-	case 'U':\
-		XB break;\
-	case 'N':case '-':\
-		XC break;\
-	case 'R':case 'K':case 'B':case 'S':case 'W':case 'H':case 'V':case 'M':case 'Y':\
-		XD break;\
-	case 'D':\
-		XE break;\
-	case 'E':case 'F':case 'I':case 'L':case 'P':case 'Q':case 'X':case 'Z':case '*':case '!':\
-		XF break;\
-	default:\
-		throw std::invalid_argument( "Unexpected char when parsing the biological sequence" );\
-}}
-
-// Make it so that the char is given where the error is thrown.
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 using namespace cppbio;
 
-
 // Declaration and Definition of objects used only within this scope
 
-static std::map<encode_type,char> encode_type2nbits {
-	{NUC_2BITS,2},
-	{NUC_3BITS,3},
-	{NUC_4BITS,4},
-	{PRO_5BITS,5}
- };
+namespace {
+
+/*
+ * Char of each code for every encoding, complement flag and molecule, built once.
+ * Complement is applied here rather than to the byte array, so that S, W, N and gap
+ * stay themselves whatever their code. RNA reads U for T.
+ */
+struct decode_tables {
+	char chars[PRO_5BITS + 1][2][2][32]={};
+
+	decode_tables(){
+		for (encode_type e: {NUC_2BITS,NUC_3BITS,NUC_4BITS,PRO_5BITS}){
+			codec::visit(e,[this,e](auto policy){
+				using P=decltype(policy);
+				constexpr uint8_t mask=(1 << P::nbits) - 1;
+				for (unsigned int comp=0;comp<2;comp++){
+					for (unsigned int rna=0;rna<2;rna++){
+						for (uint8_t code=0;code <= mask;code++){
+							char c=comp ? codec::complement(P::chars[code]) : P::chars[code];
+							if (rna && c=='T') c='U';
+							this->chars[e][comp][rna][code]=c;
+						};
+					};
+				};
+			});
+		};
+	};
+};
+
+const decode_tables tables;
+
+/*
+ * Codes unpacked as themselves, so that the bulk kernel extracts codes in read order.
+ */
+struct identity_table {
+	char codes[32];
+
+	identity_table(){
+		for (uint8_t code=0;code<32;code++) this->codes[code]=code;
+	};
+};
+
+const identity_table identity;
+
+/*
+ * Bases (A=1, C=2, G=4, T=8) an upper case IUPAC nucleotide code stands for, 0 if it
+ * is not one.
+ */
+uint8_t base_set(char c){
+	switch(c){
+	case 'A': return 1;
+	case 'C': return 2;
+	case 'G': return 4;
+	case 'T': case 'U': return 8;
+	case 'R': return 1 | 4;
+	case 'Y': return 2 | 8;
+	case 'K': return 4 | 8;
+	case 'M': return 1 | 2;
+	case 'S': return 2 | 4;
+	case 'W': return 1 | 8;
+	case 'B': return 2 | 4 | 8;
+	case 'D': return 1 | 4 | 8;
+	case 'H': return 1 | 2 | 8;
+	case 'V': return 1 | 2 | 4;
+	case 'N': return 1 | 2 | 4 | 8;
+	default: return 0;
+	};
+}
+
+/*
+ * Whether a pattern char matches an element char, both upper case. Gaps only match gaps.
+ */
+bool chars_match(char p,char t,bool nucleotide,bool ambiguous){
+	if (!nucleotide || p=='-' || t=='-') return(p==t);
+	if (ambiguous) return(base_set(p) & base_set(t));
+	return((p=='U' ? 'T' : p)==(t=='U' ? 'T' : t));
+}
+
+/*
+ * GC / (GC + AT) of element counts, read with chars.
+ */
+double gc_of(const int64_t * counts,const char * chars,std::size_t n_codes){
+	int64_t gc=0,at=0;
+	for (std::size_t code=0;code<n_codes;code++){
+		switch(chars[code]){
+		case 'G': case 'C': case 'S': gc+=counts[code]; break;
+		case 'A': case 'T': case 'U': case 'W': at+=counts[code]; break;
+		default: break;
+		};
+	};
+	return(gc + at ? double(gc) / (gc + at) : 0.0);
+}
+
+/*
+ * Copy the first n_bits bits of src after the first bit bits of dst, which holds one
+ * more byte than the bits appended. The bits following the last one appended are 0,
+ * whatever followed it in src.
+ */
+void append_bits(std::byte * dst,std::size_t bit,const std::byte * src,std::size_t n_bits){
+	if (n_bits==0) return;
+	std::byte * d=dst + bit / CHAR_BIT;
+	const uint8_t shift=bit % CHAR_BIT;
+	const std::size_t n_src=(n_bits + CHAR_BIT - 1) / CHAR_BIT;
+	if (shift==0){
+		std::memcpy(d,src,n_src);
+	}else{
+		for (std::size_t i=0;i<n_src;i++){
+			d[i]|=src[i] >> shift;
+			d[i + 1]=src[i] << (CHAR_BIT - shift);
+		};
+	};
+	const std::size_t end=bit + n_bits;
+	if (end % CHAR_BIT) dst[end / CHAR_BIT]&=std::byte(0xFF << (CHAR_BIT - end % CHAR_BIT));
+}
+
+/*
+ * PRO_5BITS code of an upper case char, 32 if it has none.
+ */
+uint8_t pro_code(char c){
+	using P=codec::policy<PRO_5BITS>;
+	for (uint8_t code=0;code<32;code++){
+		if (c!='\0' && P::chars[code]==c) return(code);
+	};
+	return(32);
+}
+
+/*
+ * PRO_5BITS code of a codon of upper case nucleotide chars.
+ */
+uint8_t translate_codon(const char * bases,const genetic_code & code){
+	uint8_t sets[3];
+	std::size_t n_gaps=0;
+	for (std::size_t k=0;k<3;k++){
+		sets[k]=base_set(bases[k]);
+		n_gaps+=(bases[k]=='-');
+	};
+	if (n_gaps==3) return(pro_code('-'));
+	// the 1bp frameshift code, then the 2bp one
+	if (n_gaps) return(pro_code('!') + (n_gaps==1));
+	// every codon the sets stand for, bit b of a set being the base of 2-bits code b
+	uint8_t r=32;
+	for (uint8_t a=0;a<4;a++){
+		if (!(sets[0] >> a & 1)) continue;
+		for (uint8_t b=0;b<4;b++){
+			if (!(sets[1] >> b & 1)) continue;
+			for (uint8_t c=0;c<4;c++){
+				if (!(sets[2] >> c & 1)) continue;
+				const uint8_t aa=code.get((a << 4) | (b << 2) | c);
+				if (r!=32 && aa!=r) return(pro_code('X'));
+				r=aa;
+			};
+		};
+	};
+	return(r==32 ? pro_code('X') : r);
+}
+
+/*
+ * PRO_5BITS code of the 3 codes of each field of 3 * nbits bits, the first code in the
+ * high bits, read in reverse and complemented as a seq.
+ */
+std::vector<uint8_t> make_codon_table(encode_type e_type,bool rev,bool comp,const genetic_code & code){
+	return(codec::visit(e_type,[rev,comp,&code](auto policy){
+		using P=decltype(policy);
+		constexpr std::size_t mask=(1 << P::nbits) - 1;
+		std::vector<uint8_t> r(std::size_t(1) << (3 * P::nbits));
+		for (std::size_t field=0;field<r.size();field++){
+			char bases[3];
+			for (std::size_t k=0;k<3;k++){
+				const char c=P::chars[(field >> (P::nbits * (2 - k))) & mask];
+				bases[rev ? 2 - k : k]=comp ? codec::complement(c) : c;
+			};
+			r[field]=translate_codon(bases,code);
+		};
+		return(r);
+	}));
+}
+
+/*
+ * Table of make_codon_table, built once per thread for each encoding, orientation and
+ * genetic code in a row (up to 4096 codons of 64 ambiguous ones for NUC_4BITS).
+ */
+const std::vector<uint8_t> & codon_table(encode_type e_type,bool rev,bool comp,const genetic_code & code){
+	struct cached {
+		uint8_t codes[64];
+		std::vector<uint8_t> table;
+	};
+	thread_local cached cache[4 * 4];
+	cached & c=cache[4 * (e_type & 3) + 2 * rev + comp];
+	bool same=!c.table.empty();
+	for (uint8_t codon=0;codon<64 && same;codon++) same=(c.codes[codon]==code.get(codon));
+	if (!same){
+		c.table=make_codon_table(e_type,rev,comp,code);
+		for (uint8_t codon=0;codon<64;codon++) c.codes[codon]=code.get(codon);
+	};
+	return(c.table);
+}
+
+}
+
+// GENETIC CODE
+genetic_code::genetic_code(const std::string & amino_acids){
+	if (amino_acids.size()!=64){
+		throw std::invalid_argument("A genetic code has 64 codons");
+	};
+	// the NCBI order of the bases of 2-bits codes A, C, G and T
+	const uint8_t ncbi[4]={2,1,3,0};
+	for (uint8_t codon=0;codon<64;codon++){
+		const char c=amino_acids[ncbi[codon >> 4] * 16 + ncbi[(codon >> 2) & 3] * 4 + ncbi[codon & 3]];
+		this->codes[codon]=pro_code(std::toupper(c));
+		if (this->codes[codon]==32){
+			throw std::invalid_argument( std::string("Unexpected char in the genetic code: ") + c );
+		};
+	};
+};
+
+genetic_code genetic_code::standard(){
+	return(genetic_code("FFLLSSSSYY**CC*WLLLLPPPPHHQQRRRRIIIMTTTTNNKKSSRRVVVVAAAADDEEGGGG"));
+};
 
-static std::map<encode_type,mol_type> encode_type2mol_type {
-	{NUC_2BITS,DNA},
-	{NUC_3BITS,DNA},
-	{NUC_4BITS,DNA},
-	{PRO_5BITS,PROTEIN}
- };
+// SEQ ARENA
+seq_arena::seq_arena(std::size_t in_slab_size):slab_size(in_slab_size){
+	if (in_slab_size==0){
+		throw std::invalid_argument("A slab must hold at least one byte");
+	};
+};
+
+std::shared_ptr<std::byte[]> seq_arena::allocate(std::size_t n){
+	if (n==0) return(nullptr);
+	if (n > this->slab_size){
+		// a dedicated slab, the current one keeps serving the small byte arrays
+		this->used+=n;
+		this->reserved+=n;
+		return(new_slab(n));
+	};
+	if (!this->slab || this->slab_used + n > this->slab_size){
+		SPDLOG_DEBUG("seq_arena::allocate new slab");
+		this->slab=new_slab(this->slab_size);
+		this->slab_used=0;
+		this->reserved+=this->slab_size;
+	};
+	std::shared_ptr<std::byte[]> r(this->slab,this->slab.get() + this->slab_used);
+	this->slab_used+=n;
+	this->used+=n;
+	return(r);
+};
+
+void seq_arena::clear(){
+	this->slab.reset();
+	this->slab_used=0;
+};
+
+std::shared_ptr<std::byte[]> seq_arena::new_slab(std::size_t n){
+#ifdef __linux__
+	const std::size_t huge_page=std::size_t(1) << 21;
+	if (n>=huge_page){
+		void * p=mmap(nullptr,n,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+		if (p!=MAP_FAILED){
+			madvise(p,n,MADV_HUGEPAGE);
+			return(std::shared_ptr<std::byte[]>(static_cast<std::byte *>(p),[n](std::byte * q){ munmap(q,n); }));
+		};
+	};
+#endif
+	return(std::shared_ptr<std::byte[]>(new std::byte[n]));
+};
 
 // CONSTRUCTORS
 template<IsAnyOf T_uint>
@@ -95,20 +292,37 @@ seq<T_uint>::seq(){
 	this->m_type=mol_UNDEFINED;
 	this->n_data=0;
 	this->n_bytes=0;
+	this->offset=0;
 	this->nbits=0;
 	this->is_rev=false;
 	this->is_comp=false;
-	this->set_miscomplemented_encoding();
-	this->data.reset(new std::byte[0]);
-	// note that decode is not defined
+	// no byte array until something is encoded
 };
 template<IsAnyOf T_uint>
-seq<T_uint>::seq(std::string & s,encode_type in_e_type,mol_type in_m_type){
+seq<T_uint>::seq(std::string_view s,encode_type in_e_type,mol_type in_m_type){
 	SPDLOG_DEBUG("seq::seq with string");
 	this->e_type=in_e_type;
 	this->m_type=in_m_type;
-	this->set_encode_parameters(s);
-	this->encode_byte_array(s);
+	this->encode_byte_array(s.data(),s.size());
+};
+template<IsAnyOf T_uint>
+seq<T_uint>::seq(seq && o) noexcept:data(std::move(o.data)),is_rev(o.is_rev),is_comp(o.is_comp),nbits(o.nbits),
+		n_bytes(o.n_bytes),n_data(o.n_data),offset(o.offset),e_type(o.e_type),m_type(o.m_type){
+	o.set_empty();
+};
+template<IsAnyOf T_uint>
+seq<T_uint>::seq(const char * s,std::size_t n,encode_type in_e_type,mol_type in_m_type){
+	SPDLOG_DEBUG("seq::seq with chars");
+	this->e_type=in_e_type;
+	this->m_type=in_m_type;
+	this->encode_byte_array(s,n);
+};
+template<IsAnyOf T_uint>
+seq<T_uint>::seq(const char * s,std::size_t n,seq_arena & arena,encode_type in_e_type,mol_type in_m_type){
+	SPDLOG_DEBUG("seq::seq with chars into an arena");
+	this->e_type=in_e_type;
+	this->m_type=in_m_type;
+	this->encode_byte_array(s,n,&arena);
 };
 
 
@@ -119,11 +333,31 @@ seq<T_uint>::~seq(){
 
 // GETTERS
 template<IsAnyOf T_uint>
-std::string seq<T_uint>::get_string(){
+std::string seq<T_uint>::get_string() const{
 	SPDLOG_DEBUG("seq::get_string");
 	return(this->decode());
 };
 
+template<IsAnyOf T_uint>
+T_uint seq<T_uint>::size() const{
+	return(this->n_data);
+};
+template<IsAnyOf T_uint>
+char seq<T_uint>::at(T_uint i) const{
+	if (i>=this->n_data){
+		throw std::out_of_range("Index after the end of the biological sequence");
+	};
+	return((*this)[i]);
+};
+template<IsAnyOf T_uint>
+typename seq<T_uint>::const_iterator seq<T_uint>::begin() const{
+	return(const_iterator(*this,0));
+};
+template<IsAnyOf T_uint>
+typename seq<T_uint>::const_iterator seq<T_uint>::end() const{
+	return(const_iterator(*this,this->n_data));
+};
+
 // MODIFIERS
 template<IsAnyOf T_uint>
 void seq<T_uint>::reverse(){
@@ -133,17 +367,26 @@ void seq<T_uint>::reverse(){
 template<IsAnyOf T_uint>
 void seq<T_uint>::complement(){
 	SPDLOG_DEBUG("seq::complement");
-	if (this->m_type!= PROTEIN){
-		for (T_uint i=0;i<this->n_bytes;i++){
-			this->data[i] = ~ this->data[i] ;
-		}
-	}else{
-		std::cerr << "Protein sequence cannot be complemented\n";
-		exit(1);
+	if (this->m_type==PROTEIN){
+		throw std::invalid_argument( "Protein sequence cannot be complemented" );
 	};
+	// the codes are complemented when they are decoded
 	this->is_comp=!this->is_comp;
-	SPDLOG_DEBUG("seq::complement this->is_comp is now " + this->is_comp) ;
-	if (this->e_type==NUC_4BITS) this->set_miscomplemented_encoding();
+	SPDLOG_DEBUG("seq::complement this->is_comp is now " + std::to_string(this->is_comp)) ;
+};
+template<IsAnyOf T_uint>
+void seq<T_uint>::materialize(){
+	SPDLOG_DEBUG("seq::materialize");
+	if (this->offset==0 && !this->is_rev) return;
+	std::shared_ptr<std::byte[]> own(new std::byte[this->n_bytes]);
+	if (this->is_rev){
+		codec::reverse(this->e_type,this->data.get(),this->offset,this->n_data,own.get());
+	}else{
+		codec::extract(this->e_type,this->data.get(),this->offset,this->n_data,own.get());
+	};
+	this->data=own;
+	this->offset=0;
+	this->is_rev=false;
 };
 template<IsAnyOf T_uint>
 void seq<T_uint>::reverse_complement(){
@@ -152,394 +395,565 @@ void seq<T_uint>::reverse_complement(){
 	this->complement();
 };
 
+template<IsAnyOf T_uint>
+seq<T_uint> seq<T_uint>::subseq(T_uint start,T_uint len) const{
+	SPDLOG_DEBUG("seq::subseq");
+	if (start > this->n_data || len > this->n_data - start){
+		throw std::out_of_range("The region ends after the biological sequence");
+	};
+	seq<T_uint> r(*this);
+	r.offset=this->offset + (this->is_rev ? this->n_data - start - len : start);
+	r.n_data=len;
+	r.n_bytes=codec::packed_size(this->e_type,len);
+	return(r);
+};
+
+// SEARCH
+template<IsAnyOf T_uint>
+T_uint seq<T_uint>::find(const std::string & pattern,T_uint from,bool both_strands,bool ambiguous) const{
+	SPDLOG_DEBUG("seq::find");
+	T_uint r=npos;
+	this->search(pattern,from,both_strands,ambiguous,[&r](std::size_t pos,bool){
+		r=pos;
+		return(false);
+	});
+	return(r);
+};
+template<IsAnyOf T_uint>
+std::vector<seq_match> seq<T_uint>::find_all(const std::string & pattern,bool both_strands,bool ambiguous) const{
+	SPDLOG_DEBUG("seq::find_all");
+	std::vector<seq_match> r;
+	this->search(pattern,0,both_strands,ambiguous,[&r](std::size_t pos,bool reverse){
+		r.push_back(seq_match {pos,reverse});
+		return(true);
+	});
+	return(r);
+};
+
+// COMPOSITION
+template<IsAnyOf T_uint>
+std::map<char,T_uint> seq<T_uint>::composition() const{
+	SPDLOG_DEBUG("seq::composition");
+	std::map<char,T_uint> r;
+	if (this->n_data==0) return(r);
+	int64_t counts[32]={};
+	this->count_codes(this->offset,this->n_data,counts,1);
+	const char * ch=this->chars();
+	for (std::size_t code=0;code<(std::size_t(1) << this->nbits);code++){
+		if (counts[code]) r[ch[code]]+=counts[code];
+	};
+	return(r);
+};
+template<IsAnyOf T_uint>
+std::vector<std::map<char,T_uint>> seq<T_uint>::composition(T_uint window,T_uint step) const{
+	SPDLOG_DEBUG("seq::composition by window");
+	std::vector<std::map<char,T_uint>> r;
+	const char * ch=this->chars();
+	this->sliding_counts(window,step,[this,&r,ch](const int64_t * counts){
+		std::map<char,T_uint> & m=r.emplace_back();
+		for (std::size_t code=0;code<(std::size_t(1) << this->nbits);code++){
+			if (counts[code]) m[ch[code]]+=counts[code];
+		};
+	});
+	return(r);
+};
+template<IsAnyOf T_uint>
+double seq<T_uint>::gc_content() const{
+	SPDLOG_DEBUG("seq::gc_content");
+	if (this->m_type==PROTEIN){
+		throw std::invalid_argument( "Protein sequence has no GC content" );
+	};
+	if (this->n_data==0) return(0.0);
+	int64_t counts[32]={};
+	this->count_codes(this->offset,this->n_data,counts,1);
+	return(gc_of(counts,this->chars(),std::size_t(1) << this->nbits));
+};
+template<IsAnyOf T_uint>
+std::vector<double> seq<T_uint>::gc_content(T_uint window,T_uint step) const{
+	SPDLOG_DEBUG("seq::gc_content by window");
+	if (this->m_type==PROTEIN){
+		throw std::invalid_argument( "Protein sequence has no GC content" );
+	};
+	std::vector<double> r;
+	const char * ch=this->chars();
+	this->sliding_counts(window,step,[this,&r,ch](const int64_t * counts){
+		r.push_back(gc_of(counts,ch,std::size_t(1) << this->nbits));
+	});
+	return(r);
+};
+
+// TRANSLATION
+template<IsAnyOf T_uint>
+seq<T_uint> seq<T_uint>::translate(uint8_t frame,const genetic_code & code) const{
+	SPDLOG_DEBUG("seq::translate");
+	if (this->m_type==PROTEIN){
+		throw std::invalid_argument( "Protein sequence cannot be translated" );
+	};
+	if (frame>2){
+		throw std::invalid_argument( "The frame must be 0, 1 or 2" );
+	};
+	const std::size_t n=this->n_data>frame ? this->n_data - frame : 0;
+	const std::size_t n_codons=n / 3;
+	seq<T_uint> r;
+	r.m_type=PROTEIN;
+	r.set_encode_parameters(PRO_5BITS,n_codons + (n % 3!=0));
+	if (r.n_data==0) return(r);
+	const std::vector<uint8_t> & table=codon_table(this->e_type,this->is_rev,this->is_comp,code);
+	const std::byte * d=this->data.get();
+	const std::size_t readable=codec::packed_size(this->e_type,this->offset + this->n_data);
+	const std::size_t width=3 * this->nbits;
+	std::byte * out=r.data.get();
+	// 5-bits codes are appended to the low bits of acc, whole bytes being written from the high ones
+	uint64_t acc=0;
+	std::size_t n_acc=0,n_out=0;
+	auto put=[&acc,&n_acc,&n_out,out](uint8_t aa){
+		acc=(acc << 5) | aa;
+		n_acc+=5;
+		if (n_acc>=CHAR_BIT){
+			n_acc-=CHAR_BIT;
+			out[n_out++]=std::byte(acc >> n_acc);
+		};
+	};
+	for (std::size_t c=0;c<n_codons;c++){
+		// element of the byte array at the high bits of the field
+		const std::size_t first=this->is_rev ? this->offset + this->n_data - 1 - frame - 3 * c - 2 : this->offset + frame + 3 * c;
+		const std::size_t bit=first * this->nbits;
+		uint64_t field;
+		if (bit / CHAR_BIT + sizeof(uint64_t) <= readable){
+			uint64_t word;
+			std::memcpy(&word,d + bit / CHAR_BIT,sizeof(word));
+			field=__builtin_bswap64(word) >> (64 - bit % CHAR_BIT - width);
+		}else{
+			field=(uint64_t(this->get_code(first)) << (2 * this->nbits)) | (uint64_t(this->get_code(first + 1)) << this->nbits) | this->get_code(first + 2);
+		};
+		put(table[field & ((uint64_t(1) << width) - 1)]);
+	};
+	if (n % 3) put(pro_code('!') + (n % 3==2));
+	if (n_acc) out[n_out++]=std::byte(acc << (CHAR_BIT - n_acc));
+	return(r);
+};
+template<IsAnyOf T_uint>
+std::vector<seq<T_uint>> seq<T_uint>::six_frame(const genetic_code & code) const{
+	SPDLOG_DEBUG("seq::six_frame");
+	std::vector<seq<T_uint>> r;
+	r.reserve(6);
+	for (uint8_t frame=0;frame<3;frame++) r.push_back(this->translate(frame,code));
+	seq<T_uint> rc(*this);
+	rc.reverse_complement();
+	for (uint8_t frame=0;frame<3;frame++) r.push_back(rc.translate(frame,code));
+	return(r);
+};
+
 // OPERATORS
 template<IsAnyOf T_uint>
-void seq<T_uint>::operator = (std::string & s){
+seq<T_uint> & seq<T_uint>::operator = (std::string_view s){
 	SPDLOG_DEBUG("seq::operator =");
 	this->e_type=enc_UNDEFINED;
 	this->m_type=mol_UNDEFINED;
-	this->set_encode_parameters(s);
-	this->encode_byte_array(s);
+	this->encode_byte_array(s.data(),s.size());
+	return(*this);
+};
+template<IsAnyOf T_uint>
+seq<T_uint> & seq<T_uint>::operator = (seq && o) noexcept{
+	if (this==&o) return(*this);
+	this->data=std::move(o.data);
+	this->is_rev=o.is_rev;
+	this->is_comp=o.is_comp;
+	this->nbits=o.nbits;
+	this->n_bytes=o.n_bytes;
+	this->n_data=o.n_data;
+	this->offset=o.offset;
+	this->e_type=o.e_type;
+	this->m_type=o.m_type;
+	o.set_empty();
+	return(*this);
 };
 
 // INTERNAL FUNCTIONS
 template<IsAnyOf T_uint>
-void seq<T_uint>::set_encode_parameters(std::string& s){
-	assert(typeid(T_uint)==typeid(uint8_t) || typeid(T_uint)==typeid(uint16_t) || typeid(T_uint)==typeid(uint32_t) || typeid(T_uint)==typeid(uint64_t));
+void seq<T_uint>::set_encode_parameters(encode_type in_e_type, std::size_t length, seq_arena * arena){
 	SPDLOG_DEBUG("seq::set_encode_parameters");
-	T_uint length=0;
-	for (char const &c: s) {
-		switch(this->e_type){
-			case (enc_UNDEFINED):
-				PARSE_STR_ENCODING(
-						this->e_type=NUC_2BITS;this->m_type=DNA;,
-						this->e_type=NUC_2BITS;this->m_type=RNA;,
-						this->e_type=NUC_3BITS;this->m_type=DNA;,
-						this->e_type=NUC_4BITS;this->m_type=DNA;,
-						this->e_type=NUC_4BITS;this->m_type=DNA;,
-						this->e_type=PRO_5BITS;this->m_type=PROTEIN;);
-				break;
-			case (NUC_2BITS):
-				PARSE_STR_ENCODING(
-						,
-						if (this->m_type==DNA){this->m_type=RNA;};,
-						this->e_type=NUC_3BITS;,
-						this->e_type=NUC_4BITS;,
-						this->e_type=NUC_4BITS;,
-						this->e_type=PRO_5BITS;this->m_type=PROTEIN;);
-				break;
-			case (NUC_3BITS):
-				PARSE_STR_ENCODING(
-						,
-						if (this->m_type==DNA){this->m_type=RNA;};,
-						,
-						this->e_type=NUC_4BITS;,
-						this->e_type=NUC_4BITS;,
-						this->e_type=PRO_5BITS;this->m_type=PROTEIN;);
-				break;
-			case (NUC_4BITS):
-				PARSE_STR_ENCODING(
-						,
-						if (this->m_type==DNA){this->m_type=RNA;};,
-						,
-						,
-						,
-						this->e_type=PRO_5BITS;this->m_type=PROTEIN;);
-				break;
-			case (PRO_5BITS):
-				PARSE_STR_ENCODING(
-						,
-						,
-						,
-						,
-						throw std::invalid_argument( "Unexpected char 'D' when parsing the protein sequence" );,
-						);
-				break;
-		};
-		length++;
-	}
-
-	this->nbits=encode_type2nbits[this->e_type] ;
-
-	this->n_bytes = (length*this->nbits) / CHAR_BIT ;
-	this->n_data = length;
-	if ((length*this->nbits) % CHAR_BIT){ this->n_bytes++; } ;
-	this->data.reset(new std::byte[this->n_bytes]);
+	this->e_type=in_e_type;
+	this->nbits=codec::nbits(in_e_type);
+	this->n_bytes=codec::packed_size(in_e_type,length);
+	this->n_data=length;
+	this->offset=0;
+	if (this->n_bytes==0){
+		// no byte array for an empty seq, as for a default constructed one
+		this->data.reset();
+	}else if (arena){
+		this->data=arena->allocate(this->n_bytes);
+	}else{
+		this->data.reset(new std::byte[this->n_bytes]);
+	};
 	this->is_rev=false;
 	this->is_comp=false;
-	switch(this->e_type){
-	case NUC_2BITS:
-		this->decode_e_type = [this](std::byte in_k,miscomplemented_encoding mis_enc){return this->decode_NUC_2BITS(in_k);};
-		this->right_append_bytecode_after_left_shift = [this](std::byte in_c, std::byte& in_b,uint8_t& in_k,encoding_astrideness in_astride){this->right_append_bytecode_after_left_shift_NUC_2BITS(in_c,in_b);};
-		this->get_byte = [this](T_uint in_k){return this->get_byte_NUC_2BITS(in_k);};
-		this->encode = [this](char in_k){return this->encode_NUC_2BITS(in_k);};
-	break;
-	case NUC_3BITS:
-		this->decode_e_type = [this](std::byte in_k,miscomplemented_encoding mis_enc){return this->decode_NUC_3BITS(in_k);};
-		this->right_append_bytecode_after_left_shift = [this](std::byte in_c, std::byte& in_b,uint8_t& in_k,encoding_astrideness in_astride){this->right_append_bytecode_after_left_shift_NUC_3BITS(in_c,in_b,in_k,in_astride);};
-		this->get_byte = [this](T_uint in_k){return this->get_byte_NUC_3BITS(in_k);};
-		this->encode = [this](char in_k){return this->encode_NUC_3BITS(in_k);};
-	break;
-	case NUC_4BITS:
-		this->decode_e_type = [this](std::byte in_k,miscomplemented_encoding mis_enc){return this->decode_NUC_4BITS(in_k,mis_enc);};
-		this->right_append_bytecode_after_left_shift = [this](std::byte in_c, std::byte& in_b,uint8_t& in_k,encoding_astrideness in_astride){this->right_append_bytecode_after_left_shift_NUC_4BITS(in_c,in_b);};
-		this->get_byte = [this](T_uint in_k){return this->get_byte_NUC_4BITS(in_k);};
-		this->encode = [this](char in_k){return this->encode_NUC_4BITS(in_k);};
-	break;
-	default: break;
-	};
-	this->set_miscomplemented_encoding();
-};
-
-template<IsAnyOf T_uint>
-void seq<T_uint>::set_miscomplemented_encoding(){
-	SPDLOG_DEBUG("seq::set_miscomplemented_encoding");
-	if (this->is_comp){
-		this->comp_dep_mis_enc.ini_n='-';
-		this->comp_dep_mis_enc.ini_gap='N';
-		this->comp_dep_mis_enc.ini_s='W';
-		this->comp_dep_mis_enc.ini_w='S';
-	}else{
-		this->comp_dep_mis_enc.ini_n='N';
-		this->comp_dep_mis_enc.ini_gap='-';
-		this->comp_dep_mis_enc.ini_s='S';
-		this->comp_dep_mis_enc.ini_w='W';
-	}
 };
 
-// DATA POSITION ITERATION FUNCTIONS
 template<IsAnyOf T_uint>
-T_uint seq<T_uint>::get_begin_data_pos(){
-	SPDLOG_DEBUG("seq::get_begin_data_pos");
-	if (this->is_rev){
-		return this->n_data-1;
-	}else{
-		return 0;
-	}
+void seq<T_uint>::set_empty(){
+	this->data.reset();
+	this->e_type=enc_UNDEFINED;
+	this->m_type=mol_UNDEFINED;
+	this->n_data=0;
+	this->n_bytes=0;
+	this->offset=0;
+	this->nbits=0;
+	this->is_rev=false;
+	this->is_comp=false;
 };
+
 template<IsAnyOf T_uint>
-void seq<T_uint>::increment_begin_data_pos(T_uint& i){
-	SPDLOG_DEBUG("seq::increment_begin_data_pos");
-	if (this->is_rev){
-		i--;
-	}else{
-		i++;
-	}
+const char * seq<T_uint>::chars() const{
+	return(tables.chars[this->e_type][this->is_comp][this->m_type==RNA]);
 };
+
 template<IsAnyOf T_uint>
-bool seq<T_uint>::is_data_pos_valid(T_uint& i){
-	SPDLOG_DEBUG("seq::is_data_pos_valid");
-	if ( i<this->n_data ){ // equivalent also to a "human" i<0 since (0-1) will become the max value for an unsigned integer
-		return true;
-	}else{
-		return false;
-	}
+void seq<T_uint>::count_codes(std::size_t first,std::size_t n,int64_t * counts,int64_t sign) const{
+	codec::visit(this->e_type,[this,first,n,counts,sign](auto policy){
+		using P=decltype(policy);
+		constexpr std::size_t n_codes=std::size_t(1) << P::nbits;
+		const std::byte * d=this->data.get();
+		std::size_t i=first;
+		const std::size_t end=first + n;
+		if constexpr (P::nbits==2){
+			// a word holds 32 crumbs, counted by one pass per code
+			constexpr std::size_t per_word=32;
+			// lowest bit of every crumb
+			constexpr uint64_t low=0x5555555555555555ULL;
+			// elements before the first whole word, and after the last one
+			for (;i<end && i % per_word;i++) counts[codec::get_code<P>(d,i)]+=sign;
+			for (;i + per_word<=end;i+=per_word){
+				const std::byte * b=d + i / 4;
+				uint64_t word=0;
+				for (std::size_t k=0;k<8;k++) word=(word << CHAR_BIT) | std::to_integer<uint64_t>(b[k]);
+				int64_t others=0;
+				for (std::size_t code=0;code + 1<n_codes;code++){
+					// crumbs equal to the code are null once XORed, then OR their bits in the lowest one
+					const uint64_t x=word ^ (low * code);
+					const int64_t c=std::popcount(~(x | x >> 1) & low);
+					counts[code]+=sign * c;
+					others+=c;
+				};
+				counts[n_codes - 1]+=sign * (int64_t(per_word) - others);
+			};
+			for (;i<end;i++) counts[codec::get_code<P>(d,i)]+=sign;
+		}else{
+			// one pass per code costs more than decoding beyond 4 codes: the codes are unpacked
+			// as themselves and counted by table, the few elements of a sliding step one by one
+			if (n<64){
+				for (;i<end;i++) counts[codec::get_code<P>(d,i)]+=sign;
+				return;
+			};
+			static constexpr std::array<char,n_codes> identity=[]{
+				std::array<char,n_codes> a{};
+				for (std::size_t code=0;code<n_codes;code++) a[code]=char(code);
+				return(a);
+			}();
+			char codes[4096];
+			// four tables so that runs of a code do not wait on the same counter
+			int64_t local[4][n_codes]={};
+			while (i<end){
+				const std::size_t len=std::min(end - i,sizeof(codes));
+				codec::unpack(P::e_type,d,i,len,codes,false,identity.data());
+				std::size_t k=0;
+				for (;k + 4<=len;k+=4){
+					local[0][uint8_t(codes[k])]++;
+					local[1][uint8_t(codes[k + 1])]++;
+					local[2][uint8_t(codes[k + 2])]++;
+					local[3][uint8_t(codes[k + 3])]++;
+				};
+				for (;k<len;k++) local[0][uint8_t(codes[k])]++;
+				i+=len;
+			};
+			for (std::size_t code=0;code<n_codes;code++) counts[code]+=sign * (local[0][code] + local[1][code] + local[2][code] + local[3][code]);
+		};
+	});
 };
 
-// ENCODING FUNCTIONS
 template<IsAnyOf T_uint>
-std::byte seq<T_uint>::encode_NUC_2BITS(char& c){
-	switch(toupper(c)){
-	case 'A': return b00; break;
-	case 'C': return b01; break;
-	case 'G': return b10; break;
-	case 'T': return b11; break;
-	default:std::string msg="Input char cannot be encoded as 2-bits DNA (ATCG only):";msg.push_back(c); throw std::invalid_argument(msg); break;
-	};
-};
-template<IsAnyOf T_uint>
-std::byte seq<T_uint>::encode_NUC_3BITS(char& c){
-	switch(toupper(c)){
-	case 'A': return(b000); break;
-	case 'C': return(b001); break;
-	case 'N': return(b010); break;
-	case '-': return(b011); break;
-	case 'G': return(b110); break;
-	case 'T': return(b111); break;
-	default:std::string msg="Input char cannot be encoded as 2-bits DNA (ATCG-N only):";msg.push_back(c); throw std::invalid_argument(msg); break;
-	};
-};
-template<IsAnyOf T_uint>
-std::byte seq<T_uint>::encode_NUC_4BITS(char& c){
-	switch(toupper(c)){
-		case 'A': return b0000; break;
-		case 'C': return b0001; break;
-		case 'R': return b0010; break;
-		case 'K': return b0011; break;
-		case 'B': return b0100; break;
-		case 'D': return b0101; break;
-		case 'S': return b0110; break;
-		case 'N': return b0111; break;
-		case '-': return b1000; break;
-		case 'W': return b1001; break;
-		case 'H': return b1010; break;
-		case 'V': return b1011; break;
-		case 'M': return b1100; break;
-		case 'Y': return b1101; break;
-		case 'G': return b1110; break;
-		case 'T': return b1111; break;
-		default:std::string msg="Input char cannot be encoded as 2-bits DNA (IUPAC letter and '-' for gap only):";msg.push_back(c); throw std::invalid_argument(msg); break;
+template<typename F>
+void seq<T_uint>::sliding_counts(T_uint window,T_uint step,F && on_window) const{
+	if (window==0 || step==0){
+		throw std::invalid_argument("Windows and steps must hold at least one element");
+	};
+	// first element in the byte array of the elements [i,i+len[ as read
+	auto first=[this](std::size_t i,std::size_t len){
+		return(this->is_rev ? this->offset + this->n_data - i - len : this->offset + i);
+	};
+	int64_t counts[32]={};
+	for (std::size_t start=0;start + window<=this->n_data;start+=step){
+		if (start==0 || step>=window){
+			std::fill(counts,counts + 32,0);
+			this->count_codes(first(start,window),window,counts,1);
+		}else{
+			this->count_codes(first(start - step,step),step,counts,-1);
+			this->count_codes(first(start - step + window,step),step,counts,1);
 		};
+		on_window(counts);
+	};
 };
+
 template<IsAnyOf T_uint>
-void seq<T_uint>::right_append_bytecode_after_left_shift_NUC_2BITS(std::byte c, std::byte& b){
-	SPDLOG_DEBUG("seq::encode_NUC_2BITS");
-	b = b << 2;
-	b |= c;
-}
-template<IsAnyOf T_uint>
-void seq<T_uint>::right_append_bytecode_after_left_shift_NUC_3BITS(std::byte c, std::byte & b,uint8_t & nbits_in_byte,encoding_astrideness astrideness){
-	SPDLOG_DEBUG("seq::encode_NUC_3BITS");
-	uint8_t nbits=3;
-	uint8_t shift=std::min(nbits_in_byte,nbits);
-	b = b << shift;
-	shift=nbits-shift;
-
-	switch (astrideness){
-	case unique_byte:
-		b |= c;
-	break;
-	case astride_first_byte:
-		b |= (c >> shift);
-	break;
-	case astride_second_byte:
-		b |= (c & (b111 >> shift));
-	break;
+template<typename F>
+void seq<T_uint>::search(const std::string & pattern,T_uint from,bool both_strands,bool ambiguous,F && on_match) const{
+	const std::size_t m=pattern.size();
+	if (m==0 || m>64){
+		throw std::invalid_argument("The pattern must have between 1 and 64 chars");
 	};
-}
-template<IsAnyOf T_uint>
-void seq<T_uint>::right_append_bytecode_after_left_shift_NUC_4BITS(std::byte c, std::byte& b){
-	SPDLOG_DEBUG("seq::encode_NUC_4BITS");
-	b = b << 4;
-	b |= c;
-}
-template<IsAnyOf T_uint>
-void seq<T_uint>::encode_byte_array(std::string& s){
-	SPDLOG_DEBUG("seq::encode");
-	uint8_t nbits_in_bytes_after_first_bit;
-	switch(this->e_type){
-	case NUC_2BITS: case NUC_4BITS:
-		for (T_uint i=0;i<this->n_data;i++){
-			this->right_append_bytecode_after_left_shift(encode(s[i]),this->data[(this->nbits * i) / CHAR_BIT],this->nbits,unique_byte);
+	const bool nucleotide=this->m_type!=PROTEIN;
+	if (both_strands && !nucleotide){
+		throw std::invalid_argument( "Protein sequence cannot be searched on both strands" );
+	};
+	std::string fwd(m,'\0'),rc(m,'\0');
+	for (std::size_t j=0;j<m;j++){
+		fwd[j]=std::toupper(static_cast<unsigned char>(pattern[j]));
+		if (nucleotide && fwd[j]!='-' && base_set(fwd[j])==0){
+			throw std::invalid_argument(std::string("Unexpected char in the nucleotide pattern: ") + pattern[j]);
 		};
-		break;
-	case NUC_3BITS: case PRO_5BITS:
-		for (T_uint i=0;i<this->n_data;i++){
-			nbits_in_bytes_after_first_bit=CHAR_BIT - i*this->nbits % CHAR_BIT;
-
-			if (nbits_in_bytes_after_first_bit<this->nbits){
-
-				this->right_append_bytecode_after_left_shift(encode(s[i]),this->data[(this->nbits * i) / CHAR_BIT],nbits_in_bytes_after_first_bit,astride_first_byte);
-
-				uint8_t nbits_in_the_next_byte=this->nbits-nbits_in_bytes_after_first_bit;
-
-				this->right_append_bytecode_after_left_shift(encode(s[i]),this->data[1 + (this->nbits * i) / CHAR_BIT],nbits_in_the_next_byte,astride_second_byte);
-			}else{
-				this->right_append_bytecode_after_left_shift(encode(s[i]),this->data[(this->nbits * i) / CHAR_BIT],nbits_in_bytes_after_first_bit,unique_byte);
-			}
+	};
+	for (std::size_t j=0;j<m;j++) rc[j]=codec::complement(fwd[m - 1 - j]=='U' ? 'T' : fwd[m - 1 - j]);
+	if (from>=this->n_data || m>std::size_t(this->n_data - from)) return;
+	// Shift-Or: bit j of a mask is cleared when the j-th pattern char matches the code
+	uint64_t masks[2][32];
+	const char * ch=this->chars();
+	for (std::size_t code=0;code<(std::size_t(1) << this->nbits);code++){
+		masks[0][code]=masks[1][code]=~uint64_t(0);
+		for (std::size_t j=0;j<m;j++){
+			if (chars_match(fwd[j],ch[code],nucleotide,ambiguous)) masks[0][code]&=~(uint64_t(1) << j);
+			if (chars_match(rc[j],ch[code],nucleotide,ambiguous)) masks[1][code]&=~(uint64_t(1) << j);
+		};
+	};
+	const uint64_t last=uint64_t(1) << (m - 1);
+	uint64_t state[2]={~uint64_t(0),~uint64_t(0)};
+	// codes are extracted in read order by chunks, with the bulk kernel
+	char codes[4096];
+	for (std::size_t i=from;i<this->n_data;i+=sizeof(codes)){
+		const std::size_t len=std::min<std::size_t>(sizeof(codes),this->n_data - i);
+		const std::size_t pos=this->is_rev ? this->offset + this->n_data - i - len : this->offset + i;
+		codec::unpack(this->e_type,this->data.get(),pos,len,codes,this->is_rev,identity.codes);
+		for (std::size_t q=0;q<len;q++){
+			const uint8_t code=codes[q];
+			state[0]=(state[0] << 1) | masks[0][code];
+			if (!(state[0] & last) && !on_match(i + q + 1 - m,false)) return;
+			if (both_strands){
+				state[1]=(state[1] << 1) | masks[1][code];
+				if (!(state[1] & last) && !on_match(i + q + 1 - m,true)) return;
+			};
 		};
-		break;
-	case enc_UNDEFINED: break;
 	};
-
-	// shift the final bits if required
-	char nshift=(CHAR_BIT * this->n_bytes)-(this->nbits * this->n_data);
-		if (nshift){ this->data[this->n_bytes-1]=data[this->n_bytes-1] << nshift;};
 };
 
-// GET BYTES FUNCTIONS
+// ENCODING FUNCTIONS
 template<IsAnyOf T_uint>
-std::byte seq<T_uint>::get_byte_NUC_2BITS(T_uint& i){
-	SPDLOG_DEBUG("seq::get_byte_NUC_2BITS");
-	char nshift=6 - 2 * (i%4);
-	std::byte byte= this->data[i/4] >> nshift;
-	return(byte & b00000011);
+void seq<T_uint>::encode_byte_array(const char * s,std::size_t n,seq_arena * arena){
+	SPDLOG_DEBUG("seq::encode");
+	if (n > std::numeric_limits<T_uint>::max()){
+		throw std::length_error("The biological sequence is too long for the index type");
+	};
+	if (n==0){
+		this->set_encode_parameters(this->e_type,0,arena);
+		return;
+	};
+	encode_type e=this->e_type;
+	if (e==enc_UNDEFINED){ e = (this->m_type==PROTEIN) ? PRO_5BITS : NUC_2BITS; };
+	uint8_t classes=0;
+	if (arena || (n > codec::get_chunk_size() && codec::get_n_threads() > 1)){
+		// Large seqs: the chars are classified, then packed with the encoding they require,
+		// both in chunks on the threads of the codec. The bytes are the ones of the single pass.
+		// Seqs of an arena too, which cannot take back a byte array left by widening.
+		classes=codec::classify(s,n);
+		if (classes & class_INVALID) codec::check(s,n);
+		this->set_encode_parameters(std::max(codec::encoding_of(classes),e),n,arena);
+		codec::pack(this->e_type,s,n,this->data.get());
+	}else{
+		// Optimistic single pass: pack with the narrowest encoding allowed and widen the packed
+		// prefix only when a char requires it, the alphabet being detected by the pack kernels.
+		this->set_encode_parameters(e,n);
+		const encode_type packed=codec::pack_widening(e,s,n,this->data.get(),0,classes,[this](std::size_t used,std::size_t size){
+			SPDLOG_DEBUG("seq::encode widen the encoding after " + std::to_string(used) + " bytes");
+			// buffers are allocated at their exact size, the prefix is widened into a new one
+			std::shared_ptr<std::byte[]> prefix=this->data;
+			this->data.reset(new std::byte[size]);
+			std::memcpy(this->data.get(),prefix.get(),used);
+			return(this->data.get());
+		});
+		this->e_type=packed;
+		this->nbits=codec::nbits(packed);
+		this->n_bytes=codec::packed_size(packed,n);
+	};
+	if (this->e_type==PRO_5BITS){
+		this->m_type=PROTEIN;
+	}else if ((classes & class_RNA) || this->m_type==RNA){
+		this->m_type=RNA;
+	}else{
+		this->m_type=DNA;
+	};
 };
-template<IsAnyOf T_uint>
-std::byte seq<T_uint>::get_byte_NUC_3BITS(T_uint& i){
-	uint8_t nbits_in_bytes_after_first_bit=CHAR_BIT - (i)*this->nbits % CHAR_BIT; //
-	SPDLOG_TRACE("seq::decode_NUC_3BITS::nbits_in_bytes_after_first_bit={}",nbits_in_bytes_after_first_bit);
-	std::byte mask;
-	std::byte byte;
-	//char byte_log;
-	uint8_t shift;
-
-	if (nbits_in_bytes_after_first_bit<this->nbits){
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::info is on 2 bytes");
-
-		uint8_t nbits_in_the_next_byte=this->nbits-nbits_in_bytes_after_first_bit;
-		mask=b00000111 >>nbits_in_the_next_byte;
-
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::nbits_in_the_next_byte={}",nbits_in_the_next_byte);
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::mask={}",std::bitset<8>{(long long unsigned int)mask}.to_string());
-
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::1st  byte={}",std::bitset<8>{(long long unsigned int)(this->data[(this->nbits * i) / CHAR_BIT])}.to_string());
-
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::2nd  byte={}",std::bitset<8>{(long long unsigned int)(this->data[1+(this->nbits * i) / CHAR_BIT])}.to_string());
 
-		byte= mask & (this->data[(this->nbits * i) / CHAR_BIT]);
-
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::1st  byte masked={}",std::bitset<8>{(long long unsigned int)byte}.to_string());
-
-		byte=byte<<nbits_in_the_next_byte;
-
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::1st  byte masked shifted={}",std::bitset<8>{(long long unsigned int)byte}.to_string());
-
-		shift=CHAR_BIT-nbits_in_the_next_byte;
-
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::2nd byte shift={}",shift);
-
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::2nd  byte shifted={}",std::bitset<8>{(long long unsigned int)((this->data[1 + (this->nbits * i) / CHAR_BIT] >> shift))}.to_string());
+// DECODING FUNCTIONS
+template<IsAnyOf T_uint>
+std::string seq<T_uint>::decode() const{
+	SPDLOG_DEBUG("seq::decode");
+	std::string r(this->n_data,'\0');
+	if (this->n_data==0) return(r);
+	codec::unpack(this->e_type,this->data.get(),this->offset,this->n_data,r.data(),this->is_rev,this->chars());
+	SPDLOG_TRACE("seq::decode::r= "+r);
+	return(r);
+};
 
-		byte|= (this->data[1 + (this->nbits * i) / CHAR_BIT] >> shift) ;
 
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::final byte={}",std::bitset<8>{(long long unsigned int)byte}.to_string());
-	}else{
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::info is on  byte");
-		SPDLOG_TRACE("seq::decode_NUC_3BITS::byte={}",std::bitset<8>{(long long unsigned int)(data[(this->nbits * i) / CHAR_BIT])}.to_string());
-		mask=b00000111;
-		shift=nbits_in_bytes_after_first_bit-this->nbits;
-		byte=b00000111 & (this->data[(this->nbits * i) / CHAR_BIT]>>shift);
-	}
-	return(byte);
+// SEQ BUILDER
+template<IsAnyOf T_uint>
+seq_builder<T_uint>::seq_builder(encode_type in_e_type,mol_type in_m_type):forced_e_type(in_e_type),m_type(in_m_type){
+	SPDLOG_DEBUG("seq_builder::seq_builder");
+	this->reset();
 };
+
 template<IsAnyOf T_uint>
-std::byte seq<T_uint>::get_byte_NUC_4BITS(T_uint& i){
-	SPDLOG_DEBUG("seq::get_byte_NUC_4BITS");
-	uint8_t nshift=4 * (1 - i%2);
-	std::byte byte=this->data[i/2]>>nshift;
-	return(b00001111 & byte);
+void seq_builder<T_uint>::reserve(std::size_t n){
+	this->grow(codec::packed_size(this->e_type,n) + 1,codec::packed_size(this->e_type,this->n_data));
 };
 
-// DECODING FUNCTIONS
 template<IsAnyOf T_uint>
-char seq<T_uint>::decode_NUC_2BITS(std::byte b){
-	char r{'_'};
-	SPDLOG_DEBUG("seq::decode_NUC_2BITS");
-	switch(b){
-	case b00: r='A'; break;
-	case b01: r='C'; break;
-	case b10: r='G'; break;
-	case b11: r='T'; break;
-	default:break;
+seq_builder<T_uint> & seq_builder<T_uint>::append(std::string_view s){
+	SPDLOG_DEBUG("seq_builder::append chars");
+	const std::size_t n=s.size();
+	if (n==0) return(*this);
+	if (n > std::numeric_limits<T_uint>::max() - this->n_data){
+		throw std::length_error("The biological sequence is too long for the index type");
 	};
-	return(r);
-}
+	const char * c=s.data();
+	this->grow(codec::packed_size(this->e_type,this->n_data + n) + 1,codec::packed_size(this->e_type,this->n_data));
+	// the chars completing the last group are packed apart, then shifted into place
+	std::size_t done=std::min<std::size_t>(n,(8 - this->n_data % 8) % 8);
+	if (done){
+		const uint8_t head=codec::classify(c,done);
+		if (head & class_INVALID) codec::check(c,done);
+		const encode_type needed=codec::encoding_of(head);
+		if (needed > this->e_type) this->widen(needed,this->n_data + n);
+		std::byte packed[8]={};
+		codec::pack(this->e_type,c,done,packed);
+		append_bits(this->data.get(),this->n_data * codec::nbits(this->e_type),packed,done * codec::nbits(this->e_type));
+		this->classes|=head;
+		this->n_data+=done;
+	};
+	// whole groups then, packed in place as by seq::encode_byte_array
+	if (done<n){
+		this->e_type=codec::pack_widening(this->e_type,c + done,n - done,this->data.get(),this->n_data,this->classes,[this](std::size_t used,std::size_t size){
+			this->grow(size + 1,used);
+			return(this->data.get());
+		});
+		this->n_data+=n - done;
+	};
+	return(*this);
+};
+
 template<IsAnyOf T_uint>
-char seq<T_uint>::decode_NUC_3BITS(std::byte b){
-	SPDLOG_DEBUG("seq::decode_NUC_3BITS");
-	char r {'_'};
-	switch(b){
-	case b000: r='A'; break;
-	case b001: r='C'; break;
-	case b010: case b101: r='N'; break;
-	case b011: case b100: r='-'; break;
-	case b110: r='G'; break;
-	case b111: r='T'; break;
-	default:break;
+seq_builder<T_uint> & seq_builder<T_uint>::append(const seq<T_uint> & s){
+	SPDLOG_DEBUG("seq_builder::append seq");
+	const std::size_t n=s.size();
+	if (n==0) return(*this);
+	if (this->n_data && (s.m_type==PROTEIN)!=(this->e_type==PRO_5BITS)){
+		throw std::invalid_argument("Protein and nucleotide sequences cannot be joined");
 	};
-	return(r);
-}
+	if (s.is_comp){
+		// complement is a property of the chars, not of the codes
+		return(this->append(s.get_string()));
+	};
+	if (n > std::numeric_limits<T_uint>::max() - this->n_data){
+		throw std::length_error("The biological sequence is too long for the index type");
+	};
+	if (s.e_type > this->e_type){
+		this->widen(s.e_type,this->n_data + n);
+	}else{
+		this->grow(codec::packed_size(this->e_type,this->n_data + n) + 1,codec::packed_size(this->e_type,this->n_data));
+	};
+	const uint8_t nbits=codec::nbits(this->e_type);
+	// the elements packed from a byte, in the encoding of the builder
+	const std::byte * src=s.data.get() + (s.offset / 8) * s.nbits;
+	std::unique_ptr<std::byte[]> own;
+	if (s.is_rev || s.offset % 8 || s.e_type!=this->e_type){
+		own.reset(new std::byte[codec::packed_size(this->e_type,n)]);
+		if (s.is_rev){
+			codec::reverse(s.e_type,s.data.get(),s.offset,n,own.get());
+		}else{
+			codec::extract(s.e_type,s.data.get(),s.offset,n,own.get());
+		};
+		if (s.e_type!=this->e_type) codec::widen(s.e_type,this->e_type,own.get(),n,own.get(),s.m_type==RNA);
+		src=own.get();
+	};
+	append_bits(this->data.get(),this->n_data * nbits,src,n * nbits);
+	this->n_data+=n;
+	if (s.m_type==RNA) this->classes|=class_RNA;
+	return(*this);
+};
 
 template<IsAnyOf T_uint>
-char seq<T_uint>::decode_NUC_4BITS(std::byte b,miscomplemented_encoding mis_enc){
-	SPDLOG_DEBUG("seq::decode_NUC_4BITS");
-	char r{'_'};
-	switch(b){
-	case b0000: r='A'; break;
-	case b0001: r='C'; break;
-	case b0010: r='R'; break;
-	case b0011: r='K'; break;
-	case b0100: r='B'; break;
-	case b0101: r='D'; break;
-	case b0110: r=mis_enc.ini_s; break;
-	case b0111: r=mis_enc.ini_n; break;
-	case b1000: r=mis_enc.ini_gap; break;
-	case b1001: r=mis_enc.ini_w; break;
-	case b1010: r='H'; break;
-	case b1011: r='V'; break;
-	case b1100: r='M'; break;
-	case b1101: r='Y'; break;
-	case b1110: r='G'; break;
-	case b1111: r='T'; break;
-	default:break;
+seq<T_uint> seq_builder<T_uint>::build(){
+	SPDLOG_DEBUG("seq_builder::build");
+	if (this->n_data==0){
+		seq<T_uint> r(std::string_view(),this->forced_e_type,this->m_type);
+		this->reset();
+		return(r);
+	};
+	seq<T_uint> r;
+	r.data=this->data;
+	r.e_type=this->e_type;
+	r.nbits=codec::nbits(this->e_type);
+	r.n_data=this->n_data;
+	r.n_bytes=codec::packed_size(this->e_type,this->n_data);
+	if (this->e_type==PRO_5BITS){
+		r.m_type=PROTEIN;
+	}else if ((this->classes & class_RNA) || this->m_type==RNA){
+		r.m_type=RNA;
+	}else{
+		r.m_type=DNA;
 	};
+	this->reset();
 	return(r);
-}
+};
+
 template<IsAnyOf T_uint>
-std::string seq<T_uint>::decode(){
-	SPDLOG_DEBUG("seq::decode");
-	std::string r = "";
-	SPDLOG_TRACE("seq::decode::start iteration");
-	for(T_uint i=this->get_begin_data_pos(); this->is_data_pos_valid(i) ; this->increment_begin_data_pos(i) ){
-		SPDLOG_TRACE("seq::decode::i={}",i);
-		SPDLOG_TRACE("seq::decode:: before push_back r= "+r);
-		r.push_back(this->decode_e_type(this->get_byte(i),this->comp_dep_mis_enc));
-	};
-	SPDLOG_TRACE("seq::decode::iteration eneded");
-	SPDLOG_TRACE("seq::decode::r= "+r);
-	return(r);
+void seq_builder<T_uint>::reset(){
+	this->data.reset();
+	this->capacity=0;
+	this->n_data=0;
+	this->classes=0;
+	this->e_type=this->forced_e_type;
+	if (this->e_type==enc_UNDEFINED){ this->e_type = (this->m_type==PROTEIN) ? PRO_5BITS : NUC_2BITS; };
 };
 
-#undef PARSE_STR_ENCODING
+template<IsAnyOf T_uint>
+void seq_builder<T_uint>::grow(std::size_t n,std::size_t used){
+	if (n<=this->capacity) return;
+	const std::size_t c=std::max(2 * this->capacity,n);
+	std::shared_ptr<std::byte[]> larger(new std::byte[c]);
+	if (used) std::memcpy(larger.get(),this->data.get(),used);
+	this->data=larger;
+	this->capacity=c;
+};
+
+template<IsAnyOf T_uint>
+void seq_builder<T_uint>::widen(encode_type to,std::size_t n){
+	SPDLOG_DEBUG("seq_builder::widen the encoding after " + std::to_string(this->n_data) + " elements");
+	// room for the n elements expected with the wider encoding, the packed ones being widened in place
+	this->grow(codec::packed_size(to,n) + 1,codec::packed_size(this->e_type,this->n_data));
+	// the chars are gone, U is told from T by the classes of the seq
+	codec::widen(this->e_type,to,this->data.get(),this->n_data,this->data.get(),this->classes & class_RNA);
+	this->e_type=to;
+};
+
+template<IsAnyOf T_uint>
+seq<T_uint> cppbio::concat(const seq<T_uint> & a,const seq<T_uint> & b){
+	SPDLOG_DEBUG("concat");
+	seq_builder<T_uint> r;
+	r.reserve(std::size_t(a.size()) + b.size());
+	r.append(a).append(b);
+	return(r.build());
+};
 
+template seq<uint8_t> cppbio::concat<uint8_t>(const seq<uint8_t> &,const seq<uint8_t> &);
+template seq<uint16_t> cppbio::concat<uint16_t>(const seq<uint16_t> &,const seq<uint16_t> &);
+template seq<uint32_t> cppbio::concat<uint32_t>(const seq<uint32_t> &,const seq<uint32_t> &);
+template seq<uint64_t> cppbio::concat<uint64_t>(const seq<uint64_t> &,const seq<uint64_t> &);
@@ -11,59 +11,23 @@
 #include <climits> // for CHAR_BIT
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <map>
-#include <functional>
 #include "spdlog/spdlog.h"
 #include <bitset>
 #include <cstddef>
 #include <cassert>
 #include <concepts>
+#include <limits>
+#include <algorithm>
+#include <compare>
+#include <iterator>
+#include <vector>
+#include "codec.hpp"
 
 namespace cppbio {
 
-	/**
-	 * @brief Definition of type `miscomplemented_encoding`
-	 *
-	 * Structure holding the char for 4 bits DNA decoding in case where the bitwise complement is not correct.
-	 *
-	 */
-
-typedef struct{
-	char ini_s; /**< char to be attributed to the initial S (S complement stays S) */
-	char ini_w; /**< char to be attributed to the initial W (W complement stays W) */
-	char ini_gap; /**< char to be attributed to the initial - (- complement stays -) */
-	char ini_n; /**< char to be attributed to the initial N (N complement stays N) */
-} miscomplemented_encoding;
-
-	/**
-	 * @brief Definition of type `encoding_astrideness`
-	 *
-	 * Enumeration of the different case of bytecode in the byte array
-	 *
-	 */
-
-typedef enum {
-		unique_byte, /**<  The bytecode in is a single adressable byte */
-		astride_first_byte, /**<  The bytecode in is a 2 addressable bytes; The first is focused*/
-		astride_second_byte /**<  The bytecode in is a 2 addressable bytes; The second is focused*/
-} encoding_astrideness;
-
-	/**
-	 * @brief Definition of type `encode_type`
-	 *
-	 * Enumeration of encoding type
-	 *
-	 */
-
-	typedef enum {
-		enc_UNDEFINED, /**<  Undefined encoding */
-		NUC_2BITS, /**<  Nucleotide encoding on 2bits */
-		NUC_3BITS, /**<  Nucleotide encoding on 3bits */
-		NUC_4BITS, /**<  Nucleotide encoding on 4bits */
-		PRO_5BITS /**<  Protein encoding on 5bits */
-	} encode_type ;
-
 	/**
 	 * @brief Definition of type `mol_type`
 	 *
@@ -85,56 +49,130 @@ typedef enum {
 	 *
 	 *  This class implement efficient encoding of biological sequence and basic operations.
 	 *
+	 *  @see encode_type for the encoding tables
 	 *
+	 */
+
+	class seq_file;
+	class seq_file_writer;
+
+	/*!
+	 * @struct seq_match
+	 * @brief A match of a pattern in a seq
 	 *
+	 */
+	struct seq_match {
+		std::size_t pos; /**<  index of the first element of the match */
+		bool reverse; /**<  whether the reverse complement of the pattern matched */
+	};
+
+	/*!
+	 * @class genetic_code
+	 * @brief Amino-acid of each codon
 	 *
+	 *  Codons are indexed by their 2-bits codes (see encode_type), first base in the most
+	 *  significant bits, so that a NUC_2BITS codon read from a byte array is its own index.
 	 *
+	 */
+	class genetic_code{
+		public:
+			/*!
+			 *  @brief Constructor
+			 *
+			 *  @param amino_acids : 64 amino-acids in the NCBI order (TTT, TTC, TTA, TTG, TCT... GGG), '*' for stops
+			 *  @throw std::invalid_argument if there are not 64 chars or a char is not an amino-acid
+			 */
+			explicit genetic_code(const std::string & amino_acids);
+			/*!
+			 *  @brief Standard genetic code
+			 *
+			 *	@return NCBI translation table 1
+			 */
+			static genetic_code standard();
+			/*!
+			 *  @brief Get the amino-acid of a codon
+			 *
+			 *  @param codon : 6-bits index of the codon
+			 *	@return PRO_5BITS code of the amino-acid
+			 */
+			uint8_t get(uint8_t codon) const{ return(this->codes[codon & 0x3F]); };
+
+		private:
+
+			uint8_t codes[64]; /**<  PRO_5BITS code of each codon */
+	};
+
+	/*!
+	 * @class seq_arena
+	 * @brief Bump allocator of the byte arrays of many small seqs
 	 *
-	 *
-	 *
-	 *  TODO 5bit amino-acid encoding
-	 *
-	 *	A               : 00000
-	 *	B               : 00001
-	 *	C               : 00010
-	 *	E               : 00011
-	 *	F               : 00100
-	 *	G               : 00101
-	 *	H               : 00110
-	 *	I               : 00111
-	 *	K               : 01000
-	 *	L               : 01001
-	 *	M               : 01010
-	 *	N               : 01011
-	 *	P               : 01100
-	 *	Q               : 01101
-	 *	R               : 01110
-	 *	S               : 01111
-	 *	T               : 10000
-	 *	U               : 10001
-	 *	V               : 10010
-	 *	W               : 10011
-	 *	X               : 10100
-	 *	Y               : 10101
-	 *	Z               : 10110
-	 *	gap             : 10111
-	 *	1bp-frameshift	: 11000
-	 *	2bp-frameshift	: 11001
-	 *	stop            : 11010
-	 *	undefined 1     : 11011
-	 *	undefined 2     : 11100
-	 *	undefined 3     : 11101
-	 *	undefined 4     : 11110
-	 *	end of sequence : 11111
+	 *  Byte arrays are carved one after the other out of large slabs (backed by huge pages
+	 *  on Linux when a slab holds at least one). A seq encoded into the arena holds its
+	 *  byte array through a shared_ptr aliasing the one of its slab: no allocation and no
+	 *  control block per seq. A slab is released in bulk once the arena and every seq
+	 *  using it are destroyed. An arena must not be shared between threads.
 	 *
 	 */
+	class seq_arena{
+		public:
+			/*!
+			 *  @brief Constructor
+			 *
+			 *  @param slab_size : number of bytes of a slab (a larger byte array gets its own slab)
+			 *  @throw std::invalid_argument if slab_size is 0
+			 */
+			explicit seq_arena(std::size_t slab_size=std::size_t(1) << 21);
+			/*!
+			 *  @brief Allocate a byte array
+			 *
+			 *  @param n : number of bytes
+			 *	@return A pointer sharing the ownership of its slab, null if n is 0
+			 */
+			std::shared_ptr<std::byte[]> allocate(std::size_t n);
+			/*!
+			 *  @brief Get the number of bytes allocated
+			 *
+			 *	@return The sum of the sizes of the byte arrays
+			 */
+			std::size_t get_used() const{ return(this->used); };
+			/*!
+			 *  @brief Get the number of bytes of the slabs
+			 *
+			 *	@return The sum of the sizes of the slabs created
+			 */
+			std::size_t get_reserved() const{ return(this->reserved); };
+			/*!
+			 *  @brief Stop allocating from the current slab
+			 *
+			 *  Slabs no longer used by any seq are released, the next allocation creates a new one.
+			 *
+			 */
+			void clear();
+
+		private:
+
+			std::size_t slab_size; /**<  number of bytes of a slab */
+			std::shared_ptr<std::byte[]> slab; /**<  slab allocated from */
+			std::size_t slab_used=0; /**<  number of bytes of the slab allocated */
+			std::size_t used=0; /**<  number of bytes allocated */
+			std::size_t reserved=0; /**<  number of bytes of the slabs */
+
+			static std::shared_ptr<std::byte[]> new_slab(std::size_t n);
+	};
 
 	template<typename T_uint>
 	concept IsAnyOf = (std::same_as<T_uint, uint8_t> || std::same_as<T_uint, uint16_t> || std::same_as<T_uint, uint32_t> || std::same_as<T_uint, uint64_t>);
 
+	template<IsAnyOf T_uint>
+	class seq_batch;
+	template<IsAnyOf T_uint>
+	class seq_builder;
+
 	template<IsAnyOf T_uint>
 	class seq{
 		public:
+			class const_iterator;
+			static constexpr T_uint npos=std::numeric_limits<T_uint>::max(); /**<  index returned when nothing is found */
 			/*!
 			 *  @brief Default constructor
 			 *
@@ -152,13 +190,68 @@ typedef enum {
 			/*!
 			 *  @brief String constructor
 			 *
-			 *  String constructor without std::string as mandatory argument.
+			 *  Encode the chars of a std::string, a string literal or any view, temporaries
+			 *  included, without copying them first.
 			 *
 			 *  @param s : A string to encode within seq object
 			 *  @param e_type : Force a type of encoding
 			 *  @param m_type : Force a type of molecule
 			 */
-			explicit seq(std::string & s,encode_type in_e_type=enc_UNDEFINED,mol_type in_m_type=mol_UNDEFINED);
+			explicit seq(std::string_view s,encode_type in_e_type=enc_UNDEFINED,mol_type in_m_type=mol_UNDEFINED);
+			/*!
+			 *  @brief Copy constructor
+			 *
+			 *  The copy shares the byte array. A byte array is never written once encoded (the
+			 *  modifiers only flip flags or give the seq a new array), so that sharing it is
+			 *  copy-on-write: copies behave as deep copies without copying any element.
+			 *
+			 *  @param o : seq to copy
+			 */
+			seq(const seq & o)=default;
+			/*!
+			 *  @brief Move constructor
+			 *
+			 *  The byte array is taken over, o is left empty.
+			 *
+			 *  @param o : seq to move
+			 */
+			seq(seq && o) noexcept;
+			/*!
+			 *  @brief Copy assignment
+			 *
+			 *  @param o : seq to copy, whose byte array is shared
+			 */
+			seq & operator = (const seq & o)=default;
+			/*!
+			 *  @brief Move assignment
+			 *
+			 *  @param o : seq to move, left empty
+			 */
+			seq & operator = (seq && o) noexcept;
+			/*!
+			 *  @brief Chars constructor
+			 *
+			 *  Encode chars that are not held by a std::string, such as the views of a fastx_record.
+			 *
+			 *  @param s : First char to encode
+			 *  @param n : Number of chars to encode
+			 *  @param e_type : Force a type of encoding
+			 *  @param m_type : Force a type of molecule
+			 */
+			seq(const char * s,std::size_t n,encode_type in_e_type=enc_UNDEFINED,mol_type in_m_type=mol_UNDEFINED);
+			/*!
+			 *  @brief Chars constructor into an arena
+			 *
+			 *  The byte array is allocated from the arena (see seq_arena). The chars are classified
+			 *  before it is allocated, so that it is allocated once with the encoding they require.
+			 *
+			 *  @param s : First char to encode
+			 *  @param n : Number of chars to encode
+			 *  @param arena : arena allocating the byte array
+			 *  @param e_type : Force a type of encoding
+			 *  @param m_type : Force a type of molecule
+			 */
+			seq(const char * s,std::size_t n,seq_arena & arena,encode_type in_e_type=enc_UNDEFINED,mol_type in_m_type=mol_UNDEFINED);
 			/*!
 			 *  @brief Operator = string
 			 *
@@ -166,13 +259,16 @@ typedef enum {
 			 *  Any other data seq object held before is erased.
 			 *
 			 *  @param s : A string to encode within seq object
+			 *  @return The seq
 			 */
-			void operator = (std::string & s);
+			seq & operator = (std::string_view s);
 			/*!
 			 *  @brief Complement the seq
 			 *
-			 *  Implement the complement operation for DNA or RNA.
+			 *  Implement the complement operation for DNA or RNA. Like reverse, it only sets a
+			 *  flag applied when elements are read, the byte array (possibly shared) is untouched.
 			 *
+			 *  @throw std::invalid_argument for a protein
 			 */
 			void complement();
 			/*!
@@ -182,6 +278,15 @@ typedef enum {
 			 *
 			 */
 			void reverse();
+			/*!
+			 *  @brief Write the elements in the byte array in the order they are read
+			 *
+			 *  A reversed seq or a region gets its own byte array holding its elements forward,
+			 *  so that later passes read memory forward. The seq read is unchanged, complement
+			 *  stays a flag applied when decoding.
+			 *
+			 */
+			void materialize();
 			/*!
 			 *  @brief reverse the seq
 			 *
@@ -189,6 +294,212 @@ typedef enum {
 			 *
 			 */
 			void reverse_complement();
+			/*!
+			 *  @brief Get the number of elements
+			 *
+			 *	@return The number of bases or amino-acids
+			 *
+			 */
+			T_uint size() const;
+			/*!
+			 *  @brief Get the encoding type
+			 *
+			 *	@return The encoding of the byte array
+			 *
+			 */
+			encode_type get_e_type() const{ return(this->e_type); };
+			/*!
+			 *  @brief Get the molecule type
+			 *
+			 *	@return The molecule type
+			 *
+			 */
+			mol_type get_m_type() const{ return(this->m_type); };
+			/*!
+			 *  @brief Whether the seq is read in reverse
+			 *
+			 *	@return The reverse flag
+			 *
+			 */
+			bool get_is_rev() const{ return(this->is_rev); };
+			/*!
+			 *  @brief Whether the elements are read as their complement
+			 *
+			 *	@return The complement flag
+			 *
+			 */
+			bool get_is_comp() const{ return(this->is_comp); };
+			/*!
+			 *  @brief Get the packed byte array
+			 *
+			 *  Elements [get_offset(), get_offset() + size()[ of the array are the seq, in the
+			 *  forward orientation and not complemented (see codec for the layout).
+			 *
+			 *	@return The first byte of the array
+			 *
+			 */
+			const std::byte * get_data() const{ return(this->data.get()); };
+			/*!
+			 *  @brief Get the index of the first element in the packed byte array
+			 *
+			 *	@return The offset (non-zero for regions)
+			 *
+			 */
+			T_uint get_offset() const{ return(this->offset); };
+			/*!
+			 *  @brief Get an element
+			 *
+			 *  The element is read in the current orientation and complement, without bound checking.
+			 *
+			 *  @param i : index of the element
+			 *	@return The upper case char of the element
+			 *
+			 */
+			char operator [] (T_uint i) const{
+				return(this->chars()[this->get_code(this->is_rev ? this->offset + this->n_data - 1 - i : this->offset + i)]);
+			};
+			/*!
+			 *  @brief Get an element with bound checking
+			 *
+			 *  @param i : index of the element
+			 *	@return The upper case char of the element
+			 *  @throw std::out_of_range if i is not lower than size()
+			 *
+			 */
+			char at(T_uint i) const;
+			/*!
+			 *  @brief Iterator on the first element
+			 *
+			 *	@return A random-access iterator reading the seq in its current orientation and complement
+			 *
+			 */
+			const_iterator begin() const;
+			/*!
+			 *  @brief Iterator past the last element
+			 *
+			 *	@return A random-access iterator
+			 *
+			 */
+			const_iterator end() const;
+			/*!
+			 *  @brief Get a region of the seq
+			 *
+			 *  The region shares the byte array of the seq, nothing is copied or re-encoded.
+			 *  Positions are given in the current orientation of the seq, so that the region
+			 *  of a reversed seq is itself reversed.
+			 *
+			 *  @param start : index of the first element of the region
+			 *  @param len : number of elements of the region
+			 *	@return A seq viewing the region
+			 *  @throw std::out_of_range if the region ends after the seq
+			 *
+			 */
+			seq subseq(T_uint start,T_uint len) const;
+			/*!
+			 *  @brief Find the first match of a pattern
+			 *
+			 *  The seq is read in its current orientation and complement. Matching is bit-parallel
+			 *  (Shift-Or) over the element codes, so the seq is never decoded to chars. With
+			 *  `ambiguous`, nucleotide IUPAC codes match as sets of bases on both sides (N matches
+			 *  any base, R matches A or G...), otherwise chars must be equal.
+			 *
+			 *  @param pattern : 1 to 64 chars (case insensitive)
+			 *  @param from : index where the search starts
+			 *  @param both_strands : whether the reverse complement of the pattern is searched too
+			 *  @param ambiguous : whether IUPAC codes match as sets
+			 *	@return The index of the first element of the first match, npos if none
+			 *  @throw std::invalid_argument if the pattern is empty, longer than 64 or not a nucleotide pattern for a nucleotide seq, or if both strands of a protein are searched
+			 *
+			 */
+			T_uint find(const std::string & pattern,T_uint from=0,bool both_strands=false,bool ambiguous=true) const;
+			/*!
+			 *  @brief Find all the matches of a pattern
+			 *
+			 *  Matches may overlap. When both strands are searched, the matches of the pattern
+			 *  and of its reverse complement are reported in a single pass.
+			 *
+			 *  @param pattern : 1 to 64 chars (case insensitive)
+			 *  @param both_strands : whether the reverse complement of the pattern is searched too
+			 *  @param ambiguous : whether IUPAC codes match as sets
+			 *	@return The matches, ordered by position
+			 *  @throw std::invalid_argument if the pattern is empty, longer than 64 or not a nucleotide pattern for a nucleotide seq, or if both strands of a protein are searched
+			 *
+			 */
+			std::vector<seq_match> find_all(const std::string & pattern,bool both_strands=false,bool ambiguous=true) const;
+			/*!
+			 *  @brief Count each element
+			 *
+			 *  Codes are counted on whole 64-bits words of the byte array (XOR with the code
+			 *  repeated in every field, then popcount of the null fields), only the elements of
+			 *  the partial words at both ends are read one by one. Counts are given for the chars
+			 *  read, i.e. with the complement applied.
+			 *
+			 *	@return The number of occurrences of each upper case char of the seq
+			 *
+			 */
+			std::map<char,T_uint> composition() const;
+			/*!
+			 *  @brief Count each element in sliding windows
+			 *
+			 *  Windows start every `step` elements, in the current orientation, and the last
+			 *  window ends at most at the end of the seq. Each window is counted from the
+			 *  previous one, adding and removing the elements that differ.
+			 *
+			 *  @param window : number of elements of a window
+			 *  @param step : number of elements between the starts of two windows
+			 *	@return The composition of each window
+			 *  @throw std::invalid_argument if window or step is 0
+			 *
+			 */
+			std::vector<std::map<char,T_uint>> composition(T_uint window,T_uint step) const;
+			/*!
+			 *  @brief Get the GC content
+			 *
+			 *  G, C and S are counted as GC, A, T, U and W as AT, other elements are ignored.
+			 *
+			 *	@return GC / (GC + AT), 0 if there is no such element
+			 *  @throw std::invalid_argument for a protein
+			 *
+			 */
+			double gc_content() const;
+			/*!
+			 *  @brief Get the GC content in sliding windows
+			 *
+			 *  @param window : number of elements of a window
+			 *  @param step : number of elements between the starts of two windows
+			 *	@return The GC content of each window (see composition for the windows)
+			 *  @throw std::invalid_argument for a protein, or if window or step is 0
+			 *
+			 */
+			std::vector<double> gc_content(T_uint window,T_uint step) const;
+			/*!
+			 *  @brief Translate a frame
+			 *
+			 *  Codons are read from the byte array in the current orientation and complement,
+			 *  never decoded to chars: the bits of 3 elements index a table of their PRO_5BITS
+			 *  codes, built from the genetic code for the encoding, orientation and complement
+			 *  of the seq. Ambiguous codons give the amino-acid all their bases agree on, X
+			 *  otherwise. A codon of 3 gaps is a gap, a codon of 1 or 2 bases besides gaps, as
+			 *  the partial codon ending the frame, is a frameshift of this length ('!').
+			 *
+			 *  @param frame : index of the first element of the first codon (0, 1 or 2)
+			 *  @param code : genetic code
+			 *	@return A PRO_5BITS seq
+			 *  @throw std::invalid_argument for a protein or a frame above 2
+			 *
+			 */
+			seq translate(uint8_t frame=0,const genetic_code & code=genetic_code::standard()) const;
+			/*!
+			 *  @brief Translate the six frames
+			 *
+			 *  The reverse complement frames only flip the flags of a copy sharing the byte array.
+			 *
+			 *  @param code : genetic code
+			 *	@return The frames 0, 1 and 2 of the seq, then the ones of its reverse complement
+			 *  @throw std::invalid_argument for a protein
+			 *
+			 */
+			std::vector<seq> six_frame(const genetic_code & code=genetic_code::standard()) const;
 			/*!
 			 *  @brief Get the seq as a string.
 			 *
@@ -197,183 +508,234 @@ typedef enum {
 			 *	@return The encoded sequence as a std::string
 			 *
 			 */
-			std::string get_string();
+			std::string get_string() const;
 
 		private:
 
+			friend class seq_file;
+			friend class seq_file_writer;
+			friend class seq_batch<T_uint>;
+			friend class seq_builder<T_uint>;
+
 			// ATTRIBUTES
 
 			std::shared_ptr<std::byte[]> data;  /**<  Smart pointer to the byte array of encoded data */
 			bool is_rev; /**<  whether the seq should be read in reverse or not */
-			bool is_comp; /**<  whether the seq should be treated as complement or not */
+			bool is_comp; /**<  whether the elements should be read as their complement or not */
 			uint8_t nbits; /**<  Number of bits to store an element */
 			T_uint n_bytes; /**<  Number of bytes to encode the seq */
 			T_uint n_data; /**<  Number of element (base or amino-acid) in the seq */
+			T_uint offset; /**<  Index of the first element in the byte array (non-zero for regions) */
 			encode_type e_type; /**<  encoding type */
 			mol_type m_type; /**<  molecule type */
-			miscomplemented_encoding comp_dep_mis_enc; /**< Decoding character for encoding that might be mis-complemented by the bitwise not */
 
 			// INTERNAL FUNCTIONS
 
-			void set_encode_parameters(std::string& s);
-			void set_miscomplemented_encoding();
-
-			// DATA POSITION ITERATION FUNCTIONS
+			void set_encode_parameters(encode_type in_e_type, std::size_t length, seq_arena * arena=nullptr);
+			void set_empty();
+			const char * chars() const;
+			uint8_t get_code(std::size_t j) const{
+				return(codec::visit(this->e_type,[this,j](auto policy){return(codec::get_code<decltype(policy)>(this->data.get(),j));}));
+			};
 
-			T_uint get_begin_data_pos(); // not a reference given the function
-			void increment_begin_data_pos(T_uint& i);
-			bool is_data_pos_valid(T_uint& i);
+			void count_codes(std::size_t first,std::size_t n,int64_t * counts,int64_t sign) const;
+			template<typename F>
+			void sliding_counts(T_uint window,T_uint step,F && on_window) const;
+			template<typename F>
+			void search(const std::string & pattern,T_uint from,bool both_strands,bool ambiguous,F && on_match) const;
 
 			// ENCODING FUNCTIONS
-			// those encoding function are not well-named.
 
-			void encode_byte_array(std::string& s);
-			std::function<void (std::byte,std::byte &,uint8_t&,encoding_astrideness astride)> right_append_bytecode_after_left_shift;
-			std::function<std::byte (char &)> encode;
+			void encode_byte_array(const char * s,std::size_t n,seq_arena * arena=nullptr);
 
-			// GET BYTES FUNCTIONS
+			// DECODING FUNCTIONS
 
-			std::byte get_byte_NUC_2BITS(T_uint& i);
-			std::byte get_byte_NUC_3BITS(T_uint& i);
-			std::byte get_byte_NUC_4BITS(T_uint& i);
-			std::function<std::byte (T_uint&)> get_byte;
+			std::string decode() const;
 
-			// DECODING FUNCTIONS
+	};
 
-			std::string decode();
-			std::function<char (std::byte,miscomplemented_encoding)> decode_e_type; // if named decode there is a char/string ambiguity some times.
+	/*!
+	 * @class seq::const_iterator
+	 * @brief A random-access iterator on the elements of a seq
+	 *
+	 *  The iterator keeps the group of 8 elements (nbits bytes) it reads in a 64-bits word,
+	 *  so that walking the seq in either direction reads each byte once. It is invalidated
+	 *  by any modification of the seq.
+	 *
+	 */
+	template<IsAnyOf T_uint>
+	class seq<T_uint>::const_iterator{
+		public:
+			using iterator_category=std::random_access_iterator_tag;
+			using value_type=char;
+			using difference_type=std::ptrdiff_t;
+			using pointer=void;
+			using reference=char;
+
+			const_iterator()=default;
+
+			char operator * () const{
+				const std::size_t j=this->rev ? this->last - this->i : this->first + this->i;
+				const std::size_t g=j / 8;
+				if (g!=this->group){
+					// load the group, whose last one may be partial
+					const std::size_t b=g * this->nbits;
+					const std::size_t n=(b + this->nbits <= this->n_bytes) ? this->nbits : this->n_bytes - b;
+					this->word=0;
+					for (std::size_t k=0;k<this->nbits;k++){
+						this->word=(this->word << CHAR_BIT) | (k<n ? std::to_integer<uint64_t>(this->data[b + k]) : 0);
+					};
+					this->group=g;
+				};
+				return(this->chars[(this->word >> (this->nbits * (7 - j % 8))) & ((1 << this->nbits) - 1)]);
+			};
+			char operator [] (difference_type k) const{ return(*(*this + k)); };
+
+			const_iterator & operator ++ (){ this->i++; return(*this); };
+			const_iterator operator ++ (int){ const_iterator r(*this); this->i++; return(r); };
+			const_iterator & operator -- (){ this->i--; return(*this); };
+			const_iterator operator -- (int){ const_iterator r(*this); this->i--; return(r); };
+			const_iterator & operator += (difference_type k){ this->i+=k; return(*this); };
+			const_iterator & operator -= (difference_type k){ this->i-=k; return(*this); };
+			const_iterator operator + (difference_type k) const{ const_iterator r(*this); r.i+=k; return(r); };
+			const_iterator operator - (difference_type k) const{ const_iterator r(*this); r.i-=k; return(r); };
+			friend const_iterator operator + (difference_type k, const const_iterator & it){ return(it + k); };
+			difference_type operator - (const const_iterator & o) const{ return(this->i - o.i); };
+
+			bool operator == (const const_iterator & o) const{ return(this->i==o.i); };
+			auto operator <=> (const const_iterator & o) const{ return(this->i<=>o.i); };
 
+		private:
 
-			/*!
-			 *  @brief 2-bits nucleotide encoding
-			 *
-			 *  A : 00
-			 *  T : 01
-			 *  C : 10
-			 *  G : 11
-			 *
-			 *  @param c : char to encode
-			 *  @return byte code for input char
-			 */
-			std::byte encode_NUC_2BITS(char& c);
+			friend class seq;
+
+			const_iterator(const seq & s,difference_type in_i):
+				data(s.data.get()),chars(s.chars()),first(s.offset),last(s.offset + s.n_data - 1),
+				n_bytes(codec::packed_size(s.e_type,s.offset + s.n_data)),nbits(s.nbits),rev(s.is_rev),i(in_i){};
+
+			const std::byte * data=nullptr; /**<  byte array of the seq */
+			const char * chars=nullptr; /**<  char of each code */
+			std::size_t first=0; /**<  index of the first element in the byte array */
+			std::size_t last=0; /**<  index of the last element in the byte array */
+			std::size_t n_bytes=0; /**<  number of bytes readable */
+			uint8_t nbits=0; /**<  number of bits of an element */
+			bool rev=false; /**<  whether the seq is read in reverse */
+			difference_type i=0; /**<  index of the element in the seq orientation */
+			mutable std::size_t group=SIZE_MAX; /**<  index of the group held by word */
+			mutable uint64_t word=0; /**<  codes of the group, first one in the most significant bits */
+	};
 
+	/*!
+	 * @class seq_builder
+	 * @brief Encode a seq chunk by chunk
+	 *
+	 *  Chunks are packed as they come into a buffer growing geometrically, without being
+	 *  gathered into a string first. When a chunk holds a char the current encoding cannot,
+	 *  the elements already packed are widened in place (2, then 3, then 4 bits), the input
+	 *  is never read again. Seqs are appended packed: their elements are shifted into place
+	 *  instead of being decoded and encoded again.
+	 *
+	 *  @tparam T_uint : index type of the seq
+	 */
+	template<IsAnyOf T_uint>
+	class seq_builder{
+		public:
 			/*!
-			 *  @brief 3-bits nucleotide encoding
-			 *
-			 *  A                : 000
-			 *  C                : 001
-			 *  N                : 010
-			 *  gap              : 011
-			 *  complemented gap : 100
-			 *  complemented N   : 101
-			 *  G                : 110
-			 *  T                : 111
+			 *  @brief Constructor
 			 *
-			 *  @param c : char to encode
-			 *  @return byte code for input char
+			 *  @param e_type : Force a type of encoding (the narrowest one holding the chars if enc_UNDEFINED)
+			 *  @param m_type : Force a type of molecule
 			 */
-
-			std::byte encode_NUC_3BITS(char& c);
-
+			explicit seq_builder(encode_type in_e_type=enc_UNDEFINED,mol_type in_m_type=mol_UNDEFINED);
 			/*!
-			 *  @brief 4-bits nucleotide encoding
-			 *
-			 *
-			 *	A       : 0000
-			 *	C       : 0001
-			 *	R       : 0010
-			 *	K       : 0011
-			 *	B       : 0100
-			 *	D       : 0101
-			 *	S or W  : 0110
-			 *	N or gap: 0111
-			 *	gap or N: 1000
-			 *	W or S  : 1001
-			 *	H       : 1010
-			 *	V       : 1011
-			 *	M       : 1100
-			 *	Y       : 1101
-			 *	G       : 1110
-			 *	T       : 1111
+			 *  @brief Reserve room for elements
 			 *
-			 *  @param c : char to encode
-			 *  @return byte code for input char
+			 *  @param n : number of elements
 			 */
-
-			std::byte encode_NUC_4BITS(char& c);
-
+			void reserve(std::size_t n);
 			/*!
-			 *  @brief Right append a 2-bits bytecode in byte after left shift
+			 *  @brief Append chars
 			 *
-			 *  First we apply bitwise leftshift of 2 on the byte to be appended.
-			 *  Then modify this byte with the result of a bitwise OR between itself and the bytecode.
-			 *
-			 *  @param c : bytecode
-			 *  @param byte : appended byte
+			 *  @param s : chars to encode (case insensitive)
+			 *	@return The builder
+			 *  @throw std::invalid_argument if a char cannot be encoded
+			 *  @throw std::length_error if T_uint cannot index the seq
 			 */
-
-			void right_append_bytecode_after_left_shift_NUC_2BITS(std::byte c,std::byte & byte);
-
+			seq_builder & append(std::string_view s);
 			/*!
-			 *  @brief Right append a 3-bits bytecode in byte after left shift
+			 *  @brief Append the elements of a seq
 			 *
-			 *  First we apply bitwise leftshift of 3 on the byte to be appended.
-			 *  Then modify this byte with the result of a bitwise OR between itself and the bytecode.
+			 *  The elements are appended as read. Those of a complemented seq are decoded,
+			 *  since complement is applied to chars rather than to codes.
 			 *
-			 *  @param c : bytecode
-			 *  @param byte : appended byte
-			 *  @return decoded char
+			 *  @param s : seq to append
+			 *	@return The builder
+			 *  @throw std::invalid_argument to append a protein to a nucleotide seq or conversely
+			 *  @throw std::length_error if T_uint cannot index the seq
 			 */
-
-			void right_append_bytecode_after_left_shift_NUC_3BITS(std::byte c,std::byte & byte, uint8_t &  nbits_in_byte, encoding_astrideness astride);
-
+			seq_builder & append(const seq<T_uint> & s);
 			/*!
-			 *  @brief Right append a 4-bits bytecode in byte after left shift
-			 *
-			 *  First we apply bitwise leftshift of 4 on the byte to be appended.
-			 *  Then modify this byte with the result of a bitwise OR between itself and the bytecode.
+			 *  @brief Get the number of elements
 			 *
-			 *  @param c : bytecode
-			 *  @param byte : appended byte
+			 *	@return The number of elements appended
 			 */
-
-			void right_append_bytecode_after_left_shift_NUC_4BITS(std::byte c,std::byte & byte);
-
+			std::size_t size() const{ return(this->n_data); };
 			/*!
-			 *  @brief 2-bits nucleotide decoding
+			 *  @brief Get the encoding
 			 *
-			 *	@see encode_NUC_2BITS
-			 *  @param b : byte to decode
-			 *  @return decoded char
+			 *	@return The encoding of the elements appended
 			 */
-
-			char decode_NUC_2BITS(std::byte b);
-
+			encode_type get_e_type() const{ return(this->e_type); };
 			/*!
-			 *  @brief 3-bits nucleotide decoding
+			 *  @brief Build the seq
 			 *
-			 *	@see encode_NUC_3BITS
-			 *  @param b : byte to decode
-			 *  @return decoded char
+			 *  The seq takes the buffer over, the builder is left empty.
+			 *
+			 *	@return The seq of the elements appended
 			 */
+			seq<T_uint> build();
 
-			char decode_NUC_3BITS(std::byte b);
+		private:
 
-			/*!
-			 *  @brief 4-bits nucleotide decoding
-			 *
-			 *	@see encode_NUC_4BITS
-			 *  @param b : byte to decode
-			 *  @return decoded char
-			 */
+			// ATTRIBUTES
 
-			char decode_NUC_4BITS(std::byte b,miscomplemented_encoding mis_enc ={'S','W','-','N'});
+			std::shared_ptr<std::byte[]> data; /**<  packed elements */
+			std::size_t capacity; /**<  number of bytes of data */
+			std::size_t n_data; /**<  number of elements */
+			encode_type forced_e_type; /**<  encoding given to the constructor */
+			encode_type e_type; /**<  encoding of the elements */
+			mol_type m_type; /**<  molecule given to the constructor */
+			uint8_t classes; /**<  OR-ed char_class of the chars appended */
+
+			// INTERNAL FUNCTIONS
 
+			void reset();
+			void grow(std::size_t n,std::size_t used);
+			void widen(encode_type to,std::size_t n);
 	};
+
+	/*!
+	 *  @brief Concatenate two seqs
+	 *
+	 *  The packed elements are joined by bit shifts, see seq_builder.
+	 *
+	 *  @param a : first seq
+	 *  @param b : second seq
+	 *	@return The elements of a then the ones of b, as read
+	 *  @throw std::invalid_argument to join a protein and a nucleotide seq
+	 *  @throw std::length_error if T_uint cannot index the seq
+	 */
+	template<IsAnyOf T_uint>
+	seq<T_uint> concat(const seq<T_uint> & a,const seq<T_uint> & b);
+
 	template class seq<uint8_t>;
 	template class seq<uint16_t>;
 	template class seq<uint32_t>;
 	template class seq<uint64_t>;
+	template class seq_builder<uint8_t>;
+	template class seq_builder<uint16_t>;
+	template class seq_builder<uint32_t>;
+	template class seq_builder<uint64_t>;
 }
 
 
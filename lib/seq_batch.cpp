@@ -0,0 +1,169 @@
+/*
+ * seq_batch.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <seq_batch.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace cppbio;
+
+// CONSTRUCTORS
+template<IsAnyOf T_uint>
+seq_batch<T_uint>::seq_batch():capacity(0),offsets(1,0){
+	SPDLOG_DEBUG("seq_batch::seq_batch");
+};
+
+template<IsAnyOf T_uint>
+void seq_batch<T_uint>::reserve(std::size_t n_seqs,std::size_t n_bytes){
+	SPDLOG_DEBUG("seq_batch::reserve");
+	this->offsets.reserve(n_seqs + 1);
+	this->lengths.reserve(n_seqs);
+	this->e_types.reserve(n_seqs);
+	this->m_types.reserve(n_seqs);
+	this->flags.reserve(n_seqs);
+	if (n_bytes > this->offsets.back()) this->grow(n_bytes - this->offsets.back());
+};
+
+// MODIFIERS
+template<IsAnyOf T_uint>
+void seq_batch<T_uint>::add(const char * s,std::size_t n,encode_type in_e_type,mol_type in_m_type){
+	if (n > std::numeric_limits<T_uint>::max()){
+		throw std::length_error("The biological sequence is too long for the index type");
+	};
+	if (n==0){
+		// as an empty seq, nothing chooses the encoding
+		this->push(0,0,in_e_type,in_m_type,0);
+		return;
+	};
+	encode_type e=in_e_type;
+	if (e==enc_UNDEFINED){ e = (in_m_type==PROTEIN) ? PRO_5BITS : NUC_2BITS; };
+	// room for the widest encoding, so that the packed prefix is widened in place
+	std::byte * out=this->grow(codec::packed_size(PRO_5BITS,n));
+	uint8_t classes=0;
+	e=codec::pack_widening(e,s,n,out,0,classes,[out](std::size_t,std::size_t){ return(out); });
+	mol_type m=DNA;
+	if (e==PRO_5BITS){
+		m=PROTEIN;
+	}else if ((classes & class_RNA) || in_m_type==RNA){
+		m=RNA;
+	};
+	this->push(codec::packed_size(e,n),n,e,m,0);
+};
+
+template<IsAnyOf T_uint>
+void seq_batch<T_uint>::add(const seq<T_uint> & s){
+	const std::size_t n_bytes=s.size() ? codec::packed_size(s.get_e_type(),s.size()) : 0;
+	std::byte * out=this->grow(n_bytes);
+	if (s.size()) codec::extract(s.get_e_type(),s.get_data(),s.get_offset(),s.size(),out);
+	this->push(n_bytes,s.size(),s.get_e_type(),s.get_m_type(),(s.get_is_rev() ? 1 : 0) | (s.get_is_comp() ? 2 : 0));
+};
+
+template<IsAnyOf T_uint>
+std::size_t seq_batch<T_uint>::add(fastx_reader & reader,std::size_t max_seqs){
+	SPDLOG_DEBUG("seq_batch::add from a reader");
+	fastx_record r;
+	std::size_t n=0;
+	while (n<max_seqs && reader.next(r)){
+		this->add(r.sequence.data(),r.sequence.size());
+		n++;
+	};
+	return(n);
+};
+
+template<IsAnyOf T_uint>
+void seq_batch<T_uint>::reverse_complement(std::size_t i){
+	if (i>=this->size()){
+		throw std::out_of_range("No such sequence in the batch");
+	};
+	if (this->m_types[i]==PROTEIN){
+		throw std::invalid_argument( "Protein sequence cannot be complemented" );
+	};
+	this->flags[i]^=3;
+};
+
+// GETTERS
+template<IsAnyOf T_uint>
+seq<T_uint> seq_batch<T_uint>::operator [] (std::size_t i) const{
+	if (i>=this->size()){
+		throw std::out_of_range("No such sequence in the batch");
+	};
+	seq<T_uint> s;
+	// aliasing constructor: the seq shares the ownership of the payload
+	s.data=std::shared_ptr<std::byte[]>(this->payload,this->payload.get() + this->offsets[i]);
+	s.n_data=this->lengths[i];
+	s.n_bytes=this->offsets[i + 1] - this->offsets[i];
+	s.offset=0;
+	s.e_type=static_cast<encode_type>(this->e_types[i]);
+	s.nbits=codec::nbits(s.e_type);
+	s.m_type=static_cast<mol_type>(this->m_types[i]);
+	s.is_rev=this->flags[i] & 1;
+	s.is_comp=this->flags[i] & 2;
+	return(s);
+};
+
+template<IsAnyOf T_uint>
+std::string seq_batch<T_uint>::get_string(std::size_t i) const{
+	if (i>=this->size()){
+		throw std::out_of_range("No such sequence in the batch");
+	};
+	std::string r(this->lengths[i],'\0');
+	if (r.size()) codec::unpack(this->get_e_type(i),this->payload.get() + this->offsets[i],0,r.size(),r.data(),this->flags[i] & 1,this->chars(i));
+	return(r);
+};
+
+template<IsAnyOf T_uint>
+std::string seq_batch<T_uint>::decode(std::vector<std::size_t> & ends) const{
+	SPDLOG_DEBUG("seq_batch::decode");
+	ends.resize(this->size());
+	std::size_t total=0;
+	for (std::size_t i=0;i<this->size();i++){
+		total+=this->lengths[i];
+		ends[i]=total;
+	};
+	std::string r(total,'\0');
+	std::size_t pos=0;
+	for (std::size_t i=0;i<this->size();i++){
+		if (this->lengths[i]) codec::unpack(this->get_e_type(i),this->payload.get() + this->offsets[i],0,this->lengths[i],r.data() + pos,this->flags[i] & 1,this->chars(i));
+		pos=ends[i];
+	};
+	return(r);
+};
+
+// INTERNAL FUNCTIONS
+template<IsAnyOf T_uint>
+std::byte * seq_batch<T_uint>::grow(std::size_t n_bytes){
+	const std::size_t used=this->offsets.back();
+	if (used + n_bytes > this->capacity){
+		// views on the previous payload keep it alive
+		const std::size_t c=std::max(2 * this->capacity,used + n_bytes);
+		std::shared_ptr<std::byte[]> larger(new std::byte[c]);
+		if (used) std::memcpy(larger.get(),this->payload.get(),used);
+		this->payload=larger;
+		this->capacity=c;
+	};
+	return(this->payload.get() + used);
+};
+
+template<IsAnyOf T_uint>
+void seq_batch<T_uint>::push(std::size_t n_bytes,T_uint n,encode_type e_type,mol_type m_type,uint8_t flag){
+	this->offsets.push_back(this->offsets.back() + n_bytes);
+	this->lengths.push_back(n);
+	this->e_types.push_back(e_type);
+	this->m_types.push_back(m_type);
+	this->flags.push_back(flag);
+};
+
+template<IsAnyOf T_uint>
+const char * seq_batch<T_uint>::chars(std::size_t i) const{
+	// the decoding tables of seq, selected by a seq without byte array
+	seq<T_uint> s;
+	s.e_type=this->get_e_type(i);
+	s.m_type=static_cast<mol_type>(this->m_types[i]);
+	s.is_comp=this->flags[i] & 2;
+	return(s.chars());
+};
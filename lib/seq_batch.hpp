@@ -0,0 +1,183 @@
+/*!
+ * @file seq_batch.hpp
+ * @brief Columnar storage of many encoded sequences
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef SEQ_BATCH_HPP_
+#define SEQ_BATCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "seq.hpp"
+#include "fastx.hpp"
+
+namespace cppbio {
+
+	/*!
+	 * @class seq_batch
+	 * @brief A set of seqs stored as columns
+	 *
+	 *  The packed elements of every seq follow each other in a single payload, each seq
+	 *  starting on a byte and having its own encoding (the narrowest holding its chars).
+	 *  Seqs are described by columns: byte offset in the payload, length, encoding,
+	 *  molecule, and flags (1 if reversed, 2 if complemented, as in seq files). Kernels
+	 *  running over the whole batch thus read the payload and the columns linearly.
+	 *
+	 *  The payload grows by doubling. Views given by `operator []` share the ownership of
+	 *  the payload they point into, so that they stay valid as the batch grows.
+	 *
+	 *  @tparam T_uint : index type of the seqs
+	 */
+	template<IsAnyOf T_uint>
+	class seq_batch{
+		public:
+			/*!
+			 *  @brief Default constructor
+			 *
+			 *  An empty batch.
+			 *
+			 */
+			seq_batch();
+			/*!
+			 *  @brief Reserve room for seqs
+			 *
+			 *  @param n_seqs : number of seqs
+			 *  @param n_bytes : number of bytes of the payload
+			 */
+			void reserve(std::size_t n_seqs,std::size_t n_bytes);
+			/*!
+			 *  @brief Encode chars as a new seq
+			 *
+			 *  Chars are packed in a single pass into the payload, widened in place when a char
+			 *  requires it, as done by the constructors of seq.
+			 *
+			 *  @param s : First char to encode
+			 *  @param n : Number of chars to encode
+			 *  @param e_type : Force a type of encoding
+			 *  @param m_type : Force a type of molecule
+			 *  @throw std::invalid_argument if a char cannot be encoded
+			 *  @throw std::length_error if T_uint cannot index the seq
+			 */
+			void add(const char * s,std::size_t n,encode_type in_e_type=enc_UNDEFINED,mol_type in_m_type=mol_UNDEFINED);
+			/*!
+			 *  @brief Copy a seq
+			 *
+			 *  The packed elements are copied as stored, orientation and complement are kept as flags.
+			 *
+			 *  @param s : seq to copy
+			 */
+			void add(const seq<T_uint> & s);
+			/*!
+			 *  @brief Encode the records of a FASTA or FASTQ file
+			 *
+			 *  Single-line sequences are encoded straight from the input of the reader.
+			 *
+			 *  @param reader : reader of the records
+			 *  @param max_seqs : highest number of records to read
+			 *	@return The number of seqs added, lower than max_seqs once the input is exhausted
+			 */
+			std::size_t add(fastx_reader & reader,std::size_t max_seqs=SIZE_MAX);
+			/*!
+			 *  @brief Get the number of seqs
+			 *
+			 *	@return The number of seqs
+			 */
+			std::size_t size() const{ return(this->lengths.size()); };
+			/*!
+			 *  @brief Get the number of elements of a seq
+			 *
+			 *  @param i : index of the seq
+			 *	@return The number of elements
+			 */
+			T_uint length(std::size_t i) const{ return(this->lengths[i]); };
+			/*!
+			 *  @brief Get the encoding of a seq
+			 *
+			 *  @param i : index of the seq
+			 *	@return The encoding type
+			 */
+			encode_type get_e_type(std::size_t i) const{ return(static_cast<encode_type>(this->e_types[i])); };
+			/*!
+			 *  @brief Get the payload
+			 *
+			 *  The elements of seq i start at byte `get_payload() + get_byte_offset(i)`.
+			 *
+			 *	@return The first byte of the payload
+			 */
+			const std::byte * get_payload() const{ return(this->payload.get()); };
+			/*!
+			 *  @brief Get the offset of a seq in the payload
+			 *
+			 *  @param i : index of the seq (size() for the end of the payload)
+			 *	@return The number of bytes before the seq
+			 */
+			std::size_t get_byte_offset(std::size_t i) const{ return(this->offsets[i]); };
+			/*!
+			 *  @brief Get a view on a seq
+			 *
+			 *  The seq shares the payload, nothing is copied.
+			 *
+			 *  @param i : index of the seq
+			 *	@return The seq
+			 *  @throw std::out_of_range if there is no such seq
+			 */
+			seq<T_uint> operator [] (std::size_t i) const;
+			/*!
+			 *  @brief Reverse complement a seq
+			 *
+			 *  @param i : index of the seq
+			 *  @throw std::invalid_argument for a protein
+			 *  @throw std::out_of_range if there is no such seq
+			 */
+			void reverse_complement(std::size_t i);
+			/*!
+			 *  @brief Decode a seq
+			 *
+			 *  @param i : index of the seq
+			 *	@return The chars of the seq, in its orientation and complement
+			 *  @throw std::out_of_range if there is no such seq
+			 */
+			std::string get_string(std::size_t i) const;
+			/*!
+			 *  @brief Decode every seq
+			 *
+			 *  The chars are written into a single string by the bulk kernels, in a single pass
+			 *  over the payload.
+			 *
+			 *  @param ends : past the last char of each seq in the string
+			 *	@return The chars of the seqs, one after the other
+			 */
+			std::string decode(std::vector<std::size_t> & ends) const;
+
+		private:
+
+			// ATTRIBUTES
+
+			std::shared_ptr<std::byte[]> payload; /**<  packed elements of the seqs */
+			std::size_t capacity; /**<  number of bytes of the payload */
+			std::vector<std::size_t> offsets; /**<  byte offset of each seq, then of the end of the payload */
+			std::vector<T_uint> lengths; /**<  number of elements of each seq */
+			std::vector<uint8_t> e_types; /**<  encoding of each seq */
+			std::vector<uint8_t> m_types; /**<  molecule of each seq */
+			std::vector<uint8_t> flags; /**<  1 if reversed, 2 if complemented */
+
+			// INTERNAL FUNCTIONS
+
+			std::byte * grow(std::size_t n_bytes);
+			void push(std::size_t n_bytes,T_uint n,encode_type e_type,mol_type m_type,uint8_t flag);
+			const char * chars(std::size_t i) const;
+	};
+
+	template class seq_batch<uint8_t>;
+	template class seq_batch<uint16_t>;
+	template class seq_batch<uint32_t>;
+	template class seq_batch<uint64_t>;
+}
+
+#endif /* SEQ_BATCH_HPP_ */
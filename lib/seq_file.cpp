@@ -0,0 +1,180 @@
+/*
+ * seq_file.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <seq_file.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace cppbio;
+
+// Declaration and Definition of objects used only within this scope
+
+namespace {
+
+const char MAGIC[8]={'C','P','P','B','I','O','S','Q'};
+const uint32_t VERSION=2; // 1 stored the complemented codes of complemented seqs
+const uint32_t ORDER_MARK=0x01020304;
+const std::size_t ALIGNMENT=8;
+
+uint64_t align(uint64_t offset){
+	return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+}
+
+// WRITER
+seq_file_writer::seq_file_writer(const std::string & path){
+	this->out.open(path,std::ios::binary | std::ios::trunc);
+	if (!this->out){
+		throw std::runtime_error("Cannot create " + path + ": " + std::strerror(errno));
+	};
+	// the header is written by close, once the offsets are known
+	const seq_file_header header {};
+	this->out.write(reinterpret_cast<const char *>(&header),sizeof(header));
+	this->offset=sizeof(header);
+};
+
+seq_file_writer::~seq_file_writer(){
+	if (this->out.is_open()){
+		try {
+			this->close();
+		} catch (const std::exception & e){
+			SPDLOG_ERROR(std::string("seq_file_writer::~seq_file_writer ") + e.what());
+		};
+	};
+};
+
+void seq_file_writer::add_record(const std::string & name, const std::byte * data, uint64_t n_bytes, uint64_t n_data, uint8_t nbits, encode_type e_type, mol_type m_type, bool is_rev, bool is_comp){
+	SPDLOG_DEBUG("seq_file_writer::add " + name);
+	if (!this->ids.emplace(name,this->records.size()).second){
+		throw std::invalid_argument("Duplicated sequence name: " + name);
+	};
+	seq_file_record r {};
+	r.data_offset=this->offset;
+	r.n_data=n_data;
+	r.n_bytes=n_bytes;
+	r.name_offset=this->names.size();
+	r.name_length=name.size();
+	r.nbits=nbits;
+	r.e_type=e_type;
+	r.m_type=m_type;
+	r.flags=(is_rev ? 1 : 0) | (is_comp ? 2 : 0);
+	this->records.push_back(r);
+	this->names+=name;
+	const char padding[ALIGNMENT]={};
+	// the last byte of a region may hold the next elements
+	const uint8_t last_bits=(n_data * nbits) % CHAR_BIT;
+	if (last_bits && n_bytes){
+		this->out.write(reinterpret_cast<const char *>(data),n_bytes - 1);
+		this->out.put(std::to_integer<char>(data[n_bytes - 1] & std::byte(0xFF << (CHAR_BIT - last_bits))));
+	}else{
+		this->out.write(reinterpret_cast<const char *>(data),n_bytes);
+	};
+	this->out.write(padding,align(this->offset + n_bytes) - this->offset - n_bytes);
+	this->offset=align(this->offset + n_bytes);
+};
+
+void seq_file_writer::close(){
+	SPDLOG_DEBUG("seq_file_writer::close");
+	seq_file_header header {};
+	std::memcpy(header.magic,MAGIC,sizeof(MAGIC));
+	header.version=VERSION;
+	header.byte_order=ORDER_MARK;
+	header.n_records=this->records.size();
+	header.index_offset=this->offset;
+	header.names_offset=this->offset + this->records.size() * sizeof(seq_file_record);
+	this->out.write(reinterpret_cast<const char *>(this->records.data()),this->records.size() * sizeof(seq_file_record));
+	this->out.write(this->names.data(),this->names.size());
+	this->out.seekp(0);
+	this->out.write(reinterpret_cast<const char *>(&header),sizeof(header));
+	this->out.close();
+	if (!this->out){
+		throw std::runtime_error("Cannot write the seq file");
+	};
+};
+
+// READER
+seq_file::seq_file(const std::string & path){
+	SPDLOG_DEBUG("seq_file::seq_file " + path);
+	const int fd=::open(path.c_str(),O_RDONLY);
+	if (fd<0){
+		throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+	};
+	struct stat st;
+	if (fstat(fd,&st)!=0 || (std::size_t) st.st_size<sizeof(seq_file_header)){
+		::close(fd);
+		throw std::runtime_error("Not a seq file: " + path);
+	};
+	const std::size_t size=st.st_size;
+	// read-only: a seq never modifies its byte array once encoded
+	void * m=mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+	::close(fd);
+	if (m==MAP_FAILED){
+		throw std::runtime_error("Cannot map " + path + ": " + std::strerror(errno));
+	};
+	this->mapping=std::shared_ptr<void>(m,[size](void * p){munmap(p,size);});
+	this->begin=static_cast<const std::byte *>(m);
+
+	const seq_file_header * header=reinterpret_cast<const seq_file_header *>(this->begin);
+	if (std::memcmp(header->magic,MAGIC,sizeof(MAGIC))!=0 || header->version!=VERSION || header->byte_order!=ORDER_MARK
+			|| header->index_offset % ALIGNMENT || header->index_offset>size
+			|| header->n_records>(size - header->index_offset) / sizeof(seq_file_record)
+			|| header->names_offset!=header->index_offset + header->n_records * sizeof(seq_file_record)){
+		throw std::runtime_error("Not a seq file (or written on another platform): " + path);
+	};
+	this->n_records=header->n_records;
+	this->records=reinterpret_cast<const seq_file_record *>(this->begin + header->index_offset);
+	const char * names=reinterpret_cast<const char *>(this->begin + header->names_offset);
+	const std::size_t names_size=size - header->names_offset;
+	this->ids.reserve(this->n_records);
+	for (std::size_t i=0;i<this->n_records;i++){
+		const seq_file_record & r=this->records[i];
+		if (r.data_offset>header->index_offset || r.n_bytes>header->index_offset - r.data_offset
+				|| r.e_type>PRO_5BITS || (r.e_type==enc_UNDEFINED && r.n_data)
+				|| r.nbits!=codec::nbits(static_cast<encode_type>(r.e_type)) || r.m_type>PROTEIN
+				|| r.n_bytes!=codec::packed_size(static_cast<encode_type>(r.e_type),r.n_data)
+				|| r.name_offset>names_size || r.name_length>names_size - r.name_offset){
+			throw std::runtime_error("Corrupted seq file: " + path);
+		};
+		this->ids.emplace(std::string_view(names + r.name_offset,r.name_length),i);
+	};
+};
+
+// GETTERS
+std::size_t seq_file::size() const{
+	return(this->n_records);
+};
+
+std::string_view seq_file::name(std::size_t i) const{
+	const seq_file_record & r=this->record(i);
+	const seq_file_header * header=reinterpret_cast<const seq_file_header *>(this->begin);
+	return(std::string_view(reinterpret_cast<const char *>(this->begin + header->names_offset + r.name_offset),r.name_length));
+};
+
+bool seq_file::contains(std::string_view name) const{
+	return(this->ids.find(name)!=this->ids.end());
+};
+
+std::size_t seq_file::rank(std::string_view name) const{
+	auto it=this->ids.find(name);
+	if (it==this->ids.end()){
+		throw std::out_of_range("No sequence named " + std::string(name));
+	};
+	return(it->second);
+};
+
+// INTERNAL FUNCTIONS
+const seq_file_record & seq_file::record(std::size_t i) const{
+	if (i>=this->n_records){
+		throw std::out_of_range("No sequence of rank " + std::to_string(i));
+	};
+	return(this->records[i]);
+};
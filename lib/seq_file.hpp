@@ -0,0 +1,232 @@
+/*!
+ * @file seq_file.hpp
+ * @brief Indexed binary files of encoded sequences
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef SEQ_FILE_HPP_
+#define SEQ_FILE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "seq.hpp"
+
+namespace cppbio {
+
+	/*!
+	 * @struct seq_file_record
+	 * @brief Index entry of a sequence in a seq file
+	 *
+	 *  Entries are stored as is (host byte order) in the index section of the file.
+	 *
+	 */
+	struct seq_file_record {
+		uint64_t data_offset; /**<  offset of the packed bytes in the file */
+		uint64_t n_data; /**<  number of elements */
+		uint64_t n_bytes; /**<  number of packed bytes */
+		uint64_t name_offset; /**<  offset of the name in the names section */
+		uint32_t name_length; /**<  number of chars of the name */
+		uint8_t nbits; /**<  number of bits of an element */
+		uint8_t e_type; /**<  encoding type */
+		uint8_t m_type; /**<  molecule type */
+		uint8_t flags; /**<  1 if reversed, 2 if complemented */
+	};
+
+	/*!
+	 * @struct seq_file_header
+	 * @brief Header at the beginning of a seq file
+	 *
+	 *  The file is made of this header, the packed bytes of each sequence (8-bytes aligned),
+	 *  the index (one seq_file_record per sequence) and the names.
+	 *
+	 */
+	struct seq_file_header {
+		char magic[8]; /**<  "CPPBIOSQ" */
+		uint32_t version; /**<  version of the format */
+		uint32_t byte_order; /**<  0x01020304 written in host byte order */
+		uint64_t n_records; /**<  number of sequences */
+		uint64_t index_offset; /**<  offset of the index */
+		uint64_t names_offset; /**<  offset of the names */
+	};
+
+	/*!
+	 * @class seq_file_writer
+	 * @brief A class writing sequences to a seq file
+	 *
+	 *  The packed bytes of each sequence are written as they are, with their orientation,
+	 *  so that nothing is re-encoded when the file is read. Unused bits of the last byte are
+	 *  written as zeros. The index is written by `close`.
+	 *
+	 */
+	class seq_file_writer{
+		public:
+			/*!
+			 *  @brief Path constructor
+			 *
+			 *  @param path : path of the file to create
+			 *  @throw std::runtime_error if the file cannot be created
+			 */
+			explicit seq_file_writer(const std::string & path);
+			/*!
+			 *  @brief Destructor
+			 *
+			 *  Close the file if `close` has not been called.
+			 *
+			 */
+			~seq_file_writer();
+			/*!
+			 *  @brief Add a sequence
+			 *
+			 *  @param name : unique name of the sequence
+			 *  @param s : sequence to write
+			 *  @throw std::invalid_argument if the name is already used
+			 */
+			template<IsAnyOf T_uint>
+			void add(const std::string & name, const seq<T_uint> & s){
+				if (s.offset==0){
+					this->add_record(name,s.data.get(),s.n_bytes,s.n_data,s.nbits,s.e_type,s.m_type,s.is_rev,s.is_comp);
+				}else{
+					// a region is shifted to start on a byte
+					std::vector<std::byte> packed(s.n_bytes);
+					codec::extract(s.e_type,s.data.get(),s.offset,s.n_data,packed.data());
+					this->add_record(name,packed.data(),s.n_bytes,s.n_data,s.nbits,s.e_type,s.m_type,s.is_rev,s.is_comp);
+				};
+			};
+			/*!
+			 *  @brief Write the index and close the file
+			 *
+			 *  @throw std::runtime_error if the file cannot be written
+			 */
+			void close();
+
+		private:
+
+			// ATTRIBUTES
+
+			std::ofstream out; /**<  file being written */
+			uint64_t offset; /**<  current offset in the file */
+			std::vector<seq_file_record> records; /**<  index of the sequences written */
+			std::string names; /**<  names of the sequences written */
+			std::unordered_map<std::string,std::size_t> ids; /**<  rank of each name */
+
+			// INTERNAL FUNCTIONS
+
+			void add_record(const std::string & name, const std::byte * data, uint64_t n_bytes, uint64_t n_data, uint8_t nbits, encode_type e_type, mol_type m_type, bool is_rev, bool is_comp);
+
+	};
+
+	/*!
+	 * @class seq_file
+	 * @brief A class reading a memory-mapped seq file
+	 *
+	 *  Opening maps the file and indexes the names, no sequence is read or copied. Sequences
+	 *  are seq objects whose byte array points into the mapping, which is unmapped when
+	 *  neither the seq_file nor any of these sequences use it anymore.
+	 *
+	 */
+	class seq_file{
+		public:
+			/*!
+			 *  @brief Path constructor
+			 *
+			 *  @param path : path of the file to map
+			 *  @throw std::runtime_error if the file cannot be mapped or is not a valid seq file
+			 */
+			explicit seq_file(const std::string & path);
+			/*!
+			 *  @brief Get the number of sequences
+			 *
+			 *	@return number of sequences
+			 */
+			std::size_t size() const;
+			/*!
+			 *  @brief Get the name of a sequence
+			 *
+			 *  @param i : rank of the sequence in the file
+			 *	@return name of the sequence
+			 *  @throw std::out_of_range if there is no such sequence
+			 */
+			std::string_view name(std::size_t i) const;
+			/*!
+			 *  @brief Whether a sequence is in the file
+			 *
+			 *  @param name : name of the sequence
+			 *	@return whether the file has such sequence
+			 */
+			bool contains(std::string_view name) const;
+			/*!
+			 *  @brief Get the rank of a sequence
+			 *
+			 *  @param name : name of the sequence
+			 *	@return rank of the sequence in the file
+			 *  @throw std::out_of_range if there is no such sequence
+			 */
+			std::size_t rank(std::string_view name) const;
+			/*!
+			 *  @brief Get a sequence by rank
+			 *
+			 *  The sequence is backed by the mapping, without any copy.
+			 *
+			 *  @param i : rank of the sequence in the file
+			 *	@return the sequence
+			 *  @throw std::out_of_range if there is no such sequence
+			 *  @throw std::length_error if T_uint cannot index the sequence
+			 */
+			template<IsAnyOf T_uint>
+			seq<T_uint> get(std::size_t i) const{
+				const seq_file_record & r=this->record(i);
+				if (r.n_data > std::numeric_limits<T_uint>::max()){
+					throw std::length_error("The biological sequence is too long for the index type");
+				};
+				seq<T_uint> s;
+				// aliasing constructor: the seq shares the ownership of the mapping
+				s.data=std::shared_ptr<std::byte[]>(this->mapping,const_cast<std::byte *>(this->begin + r.data_offset));
+				s.n_data=r.n_data;
+				s.n_bytes=r.n_bytes;
+				s.offset=0;
+				s.e_type=static_cast<encode_type>(r.e_type);
+				s.nbits=codec::nbits(s.e_type);
+				s.m_type=static_cast<mol_type>(r.m_type);
+				s.is_rev=r.flags & 1;
+				s.is_comp=r.flags & 2;
+				return(s);
+			};
+			/*!
+			 *  @brief Get a sequence by name
+			 *
+			 *  @param name : name of the sequence
+			 *	@return the sequence
+			 *  @throw std::out_of_range if there is no such sequence
+			 *  @throw std::length_error if T_uint cannot index the sequence
+			 */
+			template<IsAnyOf T_uint>
+			seq<T_uint> get(std::string_view name) const{
+				return(this->get<T_uint>(this->rank(name)));
+			};
+
+		private:
+
+			// ATTRIBUTES
+
+			std::shared_ptr<void> mapping; /**<  owner of the mapping */
+			const std::byte * begin; /**<  first byte of the mapping */
+			const seq_file_record * records; /**<  index in the mapping */
+			std::size_t n_records; /**<  number of sequences */
+			std::unordered_map<std::string_view,std::size_t> ids; /**<  rank of each name (views on the mapping) */
+
+			// INTERNAL FUNCTIONS
+
+			const seq_file_record & record(std::size_t i) const;
+
+	};
+}
+
+#endif /* SEQ_FILE_HPP_ */
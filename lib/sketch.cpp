@@ -0,0 +1,169 @@
+/*
+ * sketch.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+
+#include <sketch.hpp>
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+using namespace cppbio;
+
+// MINIMIZERS
+template<IsAnyOf T_uint, IsKmerCode T_kmer>
+std::vector<minimizer<T_kmer>> cppbio::minimizers(const seq<T_uint> & s,uint8_t k,uint8_t w){
+	SPDLOG_DEBUG("minimizers");
+	if (w==0){
+		throw std::invalid_argument("A window must hold at least one k-mer");
+	};
+	std::vector<minimizer<T_kmer>> r;
+	// candidates of the window, increasing hashes from front to back
+	std::deque<minimizer<T_kmer>> window;
+	// report the minimizer of the window ending at the k-mer of index end
+	auto slide=[&r,&window,w](std::size_t end){
+		while (!window.empty() && window.front().pos + w <= end) window.pop_front();
+		if (!window.empty() && end + 1 >= w && (r.empty() || r.back().pos!=window.front().pos)){
+			r.push_back(window.front());
+		};
+	};
+	std::size_t end=0;
+	for (const kmer<T_kmer> & m: kmers<T_uint,T_kmer>(s,k)){
+		// windows ending at a skipped k-mer still hold the previous ones
+		for (;end<m.pos && !window.empty();end++) slide(end);
+		const minimizer<T_kmer> current {m.pos,m.canonical(),kmer_hash(m.canonical())};
+		while (!window.empty() && window.back().hash > current.hash) window.pop_back();
+		window.push_back(current);
+		end=m.pos;
+		slide(end++);
+	};
+	for (;end + k<=s.size() && !window.empty();end++) slide(end);
+	return(r);
+};
+
+template std::vector<minimizer<uint32_t>> cppbio::minimizers<uint8_t,uint32_t>(const seq<uint8_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint32_t>> cppbio::minimizers<uint16_t,uint32_t>(const seq<uint16_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint32_t>> cppbio::minimizers<uint32_t,uint32_t>(const seq<uint32_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint32_t>> cppbio::minimizers<uint64_t,uint32_t>(const seq<uint64_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint64_t>> cppbio::minimizers<uint8_t,uint64_t>(const seq<uint8_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint64_t>> cppbio::minimizers<uint16_t,uint64_t>(const seq<uint16_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint64_t>> cppbio::minimizers<uint32_t,uint64_t>(const seq<uint32_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint64_t>> cppbio::minimizers<uint64_t,uint64_t>(const seq<uint64_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint128_t>> cppbio::minimizers<uint8_t,uint128_t>(const seq<uint8_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint128_t>> cppbio::minimizers<uint16_t,uint128_t>(const seq<uint16_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint128_t>> cppbio::minimizers<uint32_t,uint128_t>(const seq<uint32_t> &,uint8_t,uint8_t);
+template std::vector<minimizer<uint128_t>> cppbio::minimizers<uint64_t,uint128_t>(const seq<uint64_t> &,uint8_t,uint8_t);
+
+// CONSTRUCTORS
+sketch::sketch(uint8_t in_k,std::size_t in_max_size,uint64_t in_max_hash):k(in_k),max_size(in_max_size),max_hash(in_max_hash){
+	if (in_k==0 || in_k>4 * sizeof(uint128_t)){
+		throw std::invalid_argument("k must be between 1 and 64");
+	};
+};
+
+sketch sketch::bottom(uint8_t k,std::size_t size){
+	SPDLOG_DEBUG("sketch::bottom");
+	if (size==0){
+		throw std::invalid_argument("A bottom-k sketch must keep at least one hash");
+	};
+	return(sketch(k,size,std::numeric_limits<uint64_t>::max()));
+};
+
+sketch sketch::fraction(uint8_t k,uint64_t scale){
+	SPDLOG_DEBUG("sketch::fraction");
+	if (scale==0){
+		throw std::invalid_argument("The scale of a FracMinHash sketch must be positive");
+	};
+	return(sketch(k,0,std::numeric_limits<uint64_t>::max() / scale));
+};
+
+// MODIFIERS
+template<IsAnyOf T_uint>
+void sketch::add(const seq<T_uint> & s){
+	SPDLOG_DEBUG("sketch::add");
+	std::vector<uint64_t> found;
+	uint64_t t=this->threshold();
+	auto collect=[this,&found,&t](const auto & range){
+		for (const auto & m: range){
+			const uint64_t h=kmer_hash(m.canonical());
+			if (h > t) continue;
+			found.push_back(h);
+			// a bottom-k sketch lowers its threshold as hashes come
+			if (this->max_size && found.size()>=4 * this->max_size){
+				this->insert(found);
+				t=this->threshold();
+			};
+		};
+	};
+	if (this->k<=4 * sizeof(uint64_t)){
+		collect(kmers<T_uint,uint64_t>(s,this->k));
+	}else{
+		collect(kmers<T_uint,uint128_t>(s,this->k));
+	};
+	this->insert(found);
+};
+
+template void sketch::add<uint8_t>(const seq<uint8_t> &);
+template void sketch::add<uint16_t>(const seq<uint16_t> &);
+template void sketch::add<uint32_t>(const seq<uint32_t> &);
+template void sketch::add<uint64_t>(const seq<uint64_t> &);
+
+// COMPARISONS
+double sketch::jaccard(const sketch & o) const{
+	this->check_comparable(o);
+	// FracMinHash sketches are compared on their whole union
+	const std::size_t limit=this->max_size ? std::min(this->max_size,o.max_size) : std::numeric_limits<std::size_t>::max();
+	std::size_t n_union=0,n_common=0;
+	auto a=this->hashes.begin(),b=o.hashes.begin();
+	while (n_union<limit && (a!=this->hashes.end() || b!=o.hashes.end())){
+		if (b==o.hashes.end() || (a!=this->hashes.end() && *a<*b)){
+			a++;
+		}else if (a==this->hashes.end() || *b<*a){
+			b++;
+		}else{
+			n_common++;
+			a++;
+			b++;
+		};
+		n_union++;
+	};
+	return(n_union ? double(n_common) / n_union : 0.0);
+};
+
+double sketch::containment(const sketch & o) const{
+	this->check_comparable(o);
+	// the hashes of this sketch above the highest one of a full bottom-k sketch are unknown to o
+	const uint64_t bound=(o.max_size && o.hashes.size()>=o.max_size) ? o.hashes.back() : std::numeric_limits<uint64_t>::max();
+	std::size_t n=0,n_common=0;
+	auto b=o.hashes.begin();
+	for (uint64_t h: this->hashes){
+		if (h > bound) break;
+		n++;
+		while (b!=o.hashes.end() && *b<h) b++;
+		if (b!=o.hashes.end() && *b==h) n_common++;
+	};
+	return(n ? double(n_common) / n : 0.0);
+};
+
+// INTERNAL FUNCTIONS
+void sketch::check_comparable(const sketch & o) const{
+	if (this->k!=o.k || (this->max_size==0)!=(o.max_size==0) || this->max_hash!=o.max_hash){
+		throw std::invalid_argument("Sketches of different kinds, k or scales cannot be compared");
+	};
+};
+
+uint64_t sketch::threshold() const{
+	if (this->max_size && this->hashes.size()>=this->max_size) return(this->hashes.back());
+	return(this->max_hash);
+};
+
+void sketch::insert(std::vector<uint64_t> & found){
+	found.insert(found.end(),this->hashes.begin(),this->hashes.end());
+	std::sort(found.begin(),found.end());
+	found.erase(std::unique(found.begin(),found.end()),found.end());
+	if (this->max_size && found.size()>this->max_size) found.resize(this->max_size);
+	this->hashes.swap(found);
+	found.clear();
+};
@@ -0,0 +1,142 @@
+/*!
+ * @file sketch.hpp
+ * @brief Minimizers and MinHash sketches of nucleotide sequences
+ * @author Julien FOURET
+ * @version 0.1
+ */
+
+#ifndef SKETCH_HPP_
+#define SKETCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "kmer.hpp"
+
+namespace cppbio {
+
+	/*!
+	 * @struct minimizer
+	 * @brief A minimizer and its position
+	 *
+	 *  @tparam T_kmer : unsigned type of the codes
+	 */
+	template<IsKmerCode T_kmer>
+	struct minimizer {
+		std::size_t pos; /**<  index of the first base of the k-mer in the seq */
+		T_kmer code; /**<  canonical code of the k-mer */
+		uint64_t hash; /**<  kmer_hash of the canonical code */
+	};
+
+	/*!
+	 *  @brief Get the (w,k)-minimizers of a seq
+	 *
+	 *  The minimizer of a window of w consecutive k-mers is its canonical k-mer of lowest
+	 *  hash, the leftmost one on ties. It is found with a monotone deque, so that each k-mer
+	 *  is hashed and compared a constant number of times. A minimizer is reported once,
+	 *  whatever the number of windows it minimizes. k-mers holding a base other than A, C,
+	 *  G or T are not part of any window.
+	 *
+	 *  @tparam T_uint : index type of the seq
+	 *  @tparam T_kmer : unsigned type of the codes, k must be at most 4 * sizeof(T_kmer)
+	 *  @param s : nucleotide seq
+	 *  @param k : number of bases of a k-mer
+	 *  @param w : number of k-mers of a window
+	 *  @return the minimizers, ordered by position
+	 *  @throw std::invalid_argument if k is 0 or too large for T_kmer, w is 0, or s is a protein
+	 */
+	template<IsAnyOf T_uint, IsKmerCode T_kmer=uint64_t>
+	std::vector<minimizer<T_kmer>> minimizers(const seq<T_uint> & s,uint8_t k,uint8_t w);
+
+	/*!
+	 * @class sketch
+	 * @brief A MinHash sketch of canonical k-mers
+	 *
+	 *  The sketch keeps the distinct kmer_hash of the canonical k-mers that are either
+	 *  among the `size` lowest (bottom-k) or below 2^64 / `scale` (FracMinHash). Seqs can
+	 *  be added in turn, the sketch of several seqs being that of their union.
+	 *
+	 */
+	class sketch{
+		public:
+			/*!
+			 *  @brief Bottom-k sketch
+			 *
+			 *  @param k : number of bases of a k-mer (at most 64)
+			 *  @param size : number of hashes kept
+			 *	@return an empty sketch
+			 *  @throw std::invalid_argument if k or size is 0, or k is larger than 64
+			 */
+			static sketch bottom(uint8_t k,std::size_t size);
+			/*!
+			 *  @brief FracMinHash sketch
+			 *
+			 *  @param k : number of bases of a k-mer (at most 64)
+			 *  @param scale : one hash every scale is kept on average
+			 *	@return an empty sketch
+			 *  @throw std::invalid_argument if k or scale is 0, or k is larger than 64
+			 */
+			static sketch fraction(uint8_t k,uint64_t scale);
+			/*!
+			 *  @brief Add the k-mers of a seq
+			 *
+			 *  @param s : nucleotide seq
+			 *  @throw std::invalid_argument if s is a protein
+			 */
+			template<IsAnyOf T_uint>
+			void add(const seq<T_uint> & s);
+			/*!
+			 *  @brief Get the hashes
+			 *
+			 *	@return the distinct hashes kept, sorted
+			 */
+			const std::vector<uint64_t> & get_hashes() const{ return(this->hashes); };
+			/*!
+			 *  @brief Get the number of hashes
+			 *
+			 *	@return number of hashes kept
+			 */
+			std::size_t size() const{ return(this->hashes.size()); };
+			/*!
+			 *  @brief Estimate the Jaccard index
+			 *
+			 *  Bottom-k sketches are compared on the lowest hashes of their union, as many as
+			 *  the smallest sketch holds.
+			 *
+			 *  @param o : sketch of the same kind, k and size or scale
+			 *	@return estimated |A and B| / |A or B| (0 if both are empty)
+			 *  @throw std::invalid_argument if the sketches are not comparable
+			 */
+			double jaccard(const sketch & o) const;
+			/*!
+			 *  @brief Estimate the containment in another sketch
+			 *
+			 *  Bottom-k sketches are compared on the hashes both could hold.
+			 *
+			 *  @param o : sketch of the same kind, k and size or scale
+			 *	@return estimated |A and B| / |A| (0 if this one is empty)
+			 *  @throw std::invalid_argument if the sketches are not comparable
+			 */
+			double containment(const sketch & o) const;
+
+		private:
+
+			sketch(uint8_t k,std::size_t max_size,uint64_t max_hash);
+
+			// ATTRIBUTES
+
+			uint8_t k; /**<  number of bases of a k-mer */
+			std::size_t max_size; /**<  number of hashes kept by a bottom-k sketch, 0 for FracMinHash */
+			uint64_t max_hash; /**<  highest hash kept by a FracMinHash sketch */
+			std::vector<uint64_t> hashes; /**<  distinct hashes, sorted */
+
+			// INTERNAL FUNCTIONS
+
+			void check_comparable(const sketch & o) const;
+			uint64_t threshold() const;
+			void insert(std::vector<uint64_t> & found);
+	};
+}
+
+#endif /* SKETCH_HPP_ */
@@ -0,0 +1,202 @@
+/*
+ * test_align.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_align.hpp>
+#include <algorithm>
+#include <random>
+
+using namespace cppbio;
+
+std::string alphabets[N_INPUTS]={"ACGT","ACGTN","ACGTRYKMSWBDHVN","ACDEFGHIKLMNPQRSTVWY"};
+
+// Gotoh on full matrices
+int32_t naive(const std::string & q,const std::string & t,const score_matrix & matrix,int32_t open,int32_t extend,align_mode mode){
+    const int32_t inf=-1000000;
+    const std::size_t m=q.size(),n=t.size();
+    std::vector<std::vector<int32_t>> h(m + 1,std::vector<int32_t>(n + 1,0)),e=h,f=h;
+    int32_t best=(mode==align_LOCAL) ? 0 : inf;
+    for (std::size_t i=0;i<=m;i++){
+        for (std::size_t j=0;j<=n;j++){
+            e[i][j]=f[i][j]=inf;
+            if (i==0 && j==0) continue;
+            if (i==0){
+                h[i][j]=(mode==align_GLOBAL) ? -(open + int32_t(j - 1) * extend) : 0;
+                continue;
+            }
+            if (j==0){
+                h[i][j]=(mode==align_LOCAL) ? 0 : -(open + int32_t(i - 1) * extend);
+                continue;
+            }
+            e[i][j]=std::max(h[i][j - 1] - open,e[i][j - 1] - extend);
+            f[i][j]=std::max(h[i - 1][j] - open,f[i - 1][j] - extend);
+            h[i][j]=std::max({h[i - 1][j - 1] + matrix.get(q[i - 1],t[j - 1]),e[i][j],f[i][j]});
+            if (mode==align_LOCAL){
+                h[i][j]=std::max(h[i][j],0);
+                best=std::max(best,h[i][j]);
+            }
+        }
+    }
+    if (mode==align_GLOBAL) return(h[m][n]);
+    if (mode==align_SEMI_GLOBAL){
+        for (std::size_t j=0;j<=n;j++) best=std::max(best,h[m][j]);
+    }
+    return(best);
+};
+
+// score of an alignment from its CIGAR
+int32_t rescore(const std::string & q,const std::string & t,const alignment & a,const score_matrix & matrix,int32_t open,int32_t extend){
+    int32_t score=0;
+    std::size_t i=a.query_begin,j=a.target_begin,len=0;
+    for (char c: a.cigar){
+        if (c>='0' && c<='9'){
+            len=len * 10 + (c - '0');
+            continue;
+        }
+        if (c=='M'){
+            for (std::size_t k=0;k<len;k++) score+=matrix.get(q[i++],t[j++]);
+        }else{
+            score-=open + int32_t(len - 1) * extend;
+            if (c=='I') i+=len;
+            else j+=len;
+        }
+        len=0;
+    }
+    BOOST_CHECK(i==a.query_end);
+    BOOST_CHECK(j==a.target_end);
+    return(score);
+};
+
+TestFixture1::TestFixture1(){
+    std::mt19937 gen(7);
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        std::uniform_int_distribution<std::size_t> pick(0,alphabets[i].size()-1);
+        for (std::size_t j=0;j<150;j++) queries[i].push_back(alphabets[i][pick(gen)]);
+        for (std::size_t n=0;n<8;n++){
+            std::string t;
+            // random flanks around the query with substitutions, insertions and deletions
+            for (std::size_t j=0;j<pick(gen) * 3;j++) t.push_back(alphabets[i][pick(gen)]);
+            for (std::size_t j=0;j<queries[i].size();j++){
+                const std::size_t r=pick(gen) + n;
+                if (r % 17==3) continue;
+                if (r % 19==5) t.append(1 + r % 4,alphabets[i][pick(gen)]);
+                t.push_back(r % 7==1 ? alphabets[i][pick(gen)] : queries[i][j]);
+            }
+            for (std::size_t j=0;j<pick(gen) * 3;j++) t.push_back(alphabets[i][pick(gen)]);
+            targets[i].push_back(n==7 ? t.substr(0,60) : t);
+        }
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_align, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( matrices )
+{
+    score_matrix b=score_matrix::blosum62();
+    BOOST_CHECK(b.get('W','W')==11);
+    BOOST_CHECK(b.get('A','R')==-1);
+    BOOST_CHECK(b.get('U','C')==b.get('C','C'));
+    BOOST_CHECK(b.get('*','A')==-4);
+    const std::string chars="ARNDCQEGHILKMFPSTWYVBZX*";
+    for (char x: chars){
+        for (char y: chars) BOOST_CHECK(b.get(x,y)==b.get(y,x));
+    }
+    score_matrix n=score_matrix::nucleotide(1,-2);
+    BOOST_CHECK(n.get('A','A')==1);
+    BOOST_CHECK(n.get('U','T')==1);
+    BOOST_CHECK(n.get('A','N')==-2);
+    BOOST_CHECK(n.get('N','N')==1);
+};
+
+BOOST_AUTO_TEST_CASE( known )
+{
+    std::string q="ACGT",t="TTACGTTT";
+    aligner<uint32_t> local(seq<uint32_t>(q),score_matrix::nucleotide());
+    alignment a=local.align(seq<uint32_t>(t),true);
+    BOOST_CHECK(a.score==8);
+    BOOST_CHECK(a.query_begin==0 && a.query_end==4);
+    BOOST_CHECK(a.target_begin==2 && a.target_end==6);
+    BOOST_CHECK(a.cigar=="4M");
+    BOOST_CHECK(local.align(seq<uint32_t>(t)).score==8);
+    BOOST_CHECK(local.align(seq<uint32_t>(t)).target_end==6);
+    // a gap of 2 in the target
+    std::string q2="AAAAACCCCCGGGGG",t2="AAAAACCCCCTTGGGGG";
+    aligner<uint32_t> global(seq<uint32_t>(q2),score_matrix::nucleotide(),5,2,align_GLOBAL);
+    a=global.align(seq<uint32_t>(t2),true);
+    BOOST_CHECK(a.score==30 - 7);
+    BOOST_CHECK(a.cigar=="10M2D5M");
+    // the query within a longer target
+    aligner<uint32_t> semi(seq<uint32_t>(q),score_matrix::nucleotide(),5,2,align_SEMI_GLOBAL);
+    a=semi.align(seq<uint32_t>(t),true);
+    BOOST_CHECK(a.score==8);
+    BOOST_CHECK(a.target_begin==2 && a.target_end==6);
+    BOOST_CHECK_THROW(aligner<uint32_t> invalid(seq<uint32_t>(q),score_matrix::nucleotide(),2,3),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( random )
+{
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        const score_matrix matrix=(i==3) ? score_matrix::blosum62() : score_matrix::nucleotide();
+        seq<uint16_t> query(queries[i]);
+        std::vector<seq<uint16_t>> seqs;
+        for (std::string t: targets[i]) seqs.emplace_back(t);
+        for (align_mode mode: {align_LOCAL,align_GLOBAL,align_SEMI_GLOBAL}){
+            for (simd_level level: {simd_NONE,simd_AVX2}){
+                codec::set_simd_level(level);
+                aligner<uint16_t> a(query,matrix,6,1,mode);
+                std::vector<alignment> scores=a.align(seqs);
+                std::vector<alignment> traces=a.align(seqs,true);
+                for (std::size_t n=0;n<seqs.size();n++){
+                    const int32_t expected=naive(queries[i],targets[i][n],matrix,6,1,mode);
+                    BOOST_CHECK(scores[n].score==expected);
+                    BOOST_CHECK(traces[n].score==expected);
+                    BOOST_CHECK(scores[n].target_end==traces[n].target_end);
+                    BOOST_CHECK(rescore(queries[i],targets[i][n],traces[n],matrix,6,1)==expected);
+                    if (mode==align_GLOBAL){
+                        BOOST_CHECK(traces[n].query_begin==0 && traces[n].target_begin==0);
+                        BOOST_CHECK(traces[n].target_end==targets[i][n].size());
+                    }
+                    if (mode!=align_LOCAL) BOOST_CHECK(traces[n].query_begin==0 && traces[n].query_end==queries[i].size());
+                }
+            }
+            codec::set_simd_level(simd_AVX2);
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE( orientation )
+{
+    std::string t=targets[2][0];
+    std::string rc(t.rbegin(),t.rend());
+    for (char & c: rc) c=codec::complement(c);
+    seq<uint32_t> s(rc);
+    s.reverse_complement();
+    aligner<uint32_t> a(seq<uint32_t>(queries[2]),score_matrix::nucleotide());
+    BOOST_CHECK(a.align(s).score==naive(queries[2],t,score_matrix::nucleotide(),5,2,align_LOCAL));
+    BOOST_CHECK(a.align(s).target_end==a.align(seq<uint32_t>(t)).target_end);
+};
+
+BOOST_AUTO_TEST_CASE( saturation )
+{
+    // scores above 255 then above 32767 leave the 8-bits then the 16-bits lanes
+    for (std::size_t length: {200,3100}){
+        std::string q(length,'W');
+        q[length / 2]='A';
+        std::string t="GG" + q + "GG";
+        for (simd_level level: {simd_NONE,simd_AVX2}){
+            codec::set_simd_level(level);
+            aligner<uint32_t> a(seq<uint32_t>(q),score_matrix::blosum62());
+            alignment r=a.align(seq<uint32_t>(t));
+            BOOST_CHECK(r.score==int32_t(length - 1) * 11 + 4);
+            BOOST_CHECK(r.query_end==length);
+            BOOST_CHECK(r.target_end==length + 2);
+        }
+        codec::set_simd_level(simd_AVX2);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,30 @@
+/*
+ * test_align.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_ALIGN_HPP_
+#define TEST_ALIGN_HPP_
+
+#include <align.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::aligner"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#define N_INPUTS 4
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	// ~TestFixture1(); not needed
+
+	std::string queries[N_INPUTS]; /**< random sequences of 2, 3, 4 and 5 bits alphabets */
+	std::vector<std::string> targets[N_INPUTS]; /**< the queries with random edits, and random sequences */
+};
+
+#endif /* TEST_ALIGN_HPP_ */
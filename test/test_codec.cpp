@@ -0,0 +1,369 @@
+/*
+ * test_codec.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_codec.hpp>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <random>
+#include <thread>
+
+using namespace cppbio;
+
+encode_type encodings[N_ENCODINGS]={NUC_2BITS,NUC_3BITS,NUC_4BITS,PRO_5BITS};
+
+std::string alphabets[N_ENCODINGS]={
+    "ACGTacgt",
+    "ACGTN-acgtn",
+    "ACRKBDSN-WHVMYGTacrkbdsnwhvmygt",
+    "ABCDEFGHIKLMNPQRSTUVWXYZ-*!abcdefghiklmnpqrstuvwxyz"
+};
+
+std::string decoded[N_ENCODINGS]={
+    "ACGT",
+    "ACN--NGT",
+    "ACRKBDSN-WHVMYGT",
+    std::string("ABCEFGHIKLMNPQRSTUVWXYZ-!!*D\0\0\0\0",32)
+};
+
+std::size_t lengths[N_LENGTHS]={0,1,7,8,15,16,33,100,1000};
+
+// Per-char path used by seq::encode_byte_array before the bulk kernels, kept as reference.
+std::vector<std::byte> pack_reference(encode_type e_type, const std::string & s){
+    const uint8_t nbits=codec::nbits(e_type);
+    const std::string codes[N_ENCODINGS]={"ACGT",std::string("ACN-\0\0GT",8),"ACRKBDSN-WHVMYGT","ABCEFGHIKLMNPQRSTUVWXYZ-!!*D"};
+    const std::string & table=codes[e_type-NUC_2BITS];
+    std::function<std::byte (char)> encode=[&table](char c){return std::byte(table.find(toupper(c)));};
+    std::function<void (std::byte,std::byte &,uint8_t)> append=[](std::byte c, std::byte & b, uint8_t shift){b=(b << shift) | c;};
+    std::vector<std::byte> r(codec::packed_size(e_type,s.size()));
+    for (std::size_t i=0;i<s.size();i++){
+        uint8_t nbits_in_bytes_after_first_bit=CHAR_BIT - i*nbits % CHAR_BIT;
+        if (nbits_in_bytes_after_first_bit<nbits){
+            uint8_t nbits_in_the_next_byte=nbits-nbits_in_bytes_after_first_bit;
+            append(encode(s[i]) >> nbits_in_the_next_byte,r[(nbits * i) / CHAR_BIT],nbits_in_bytes_after_first_bit);
+            append(encode(s[i]) & (std::byte(0xFF) >> (CHAR_BIT-nbits_in_the_next_byte)),r[1 + (nbits * i) / CHAR_BIT],nbits_in_the_next_byte);
+        }else{
+            append(encode(s[i]),r[(nbits * i) / CHAR_BIT],nbits);
+        }
+    }
+    uint8_t nshift=(CHAR_BIT * r.size())-(nbits * s.size());
+    if (nshift){ r.back()=r.back() << nshift;};
+    return(r);
+}
+
+std::vector<std::byte> pack(encode_type e_type, const std::string & s){
+    std::vector<std::byte> r(codec::packed_size(e_type,s.size()));
+    codec::pack(e_type,s.data(),s.size(),r.data());
+    return(r);
+}
+
+TestFixture1::TestFixture1(){
+    std::mt19937 gen(42);
+    for (unsigned int e=0;e<N_ENCODINGS;e++){
+        std::uniform_int_distribution<std::size_t> pick(0,alphabets[e].size()-1);
+        for (unsigned int l=0;l<N_LENGTHS;l++){
+            std::string s;
+            for (std::size_t i=0;i<lengths[l];i++) s.push_back(alphabets[e][pick(gen)]);
+            inputs[e].push_back(s);
+        }
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_codec, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( context )
+{
+    BOOST_TEST_MESSAGE( "simd level = " << codec::get_simd_level() );
+};
+
+BOOST_AUTO_TEST_CASE( pack_layout )
+{
+    simd_level levels[3]={simd_NONE,simd_SSE42,simd_AVX2};
+    const simd_level ini_level=codec::get_simd_level();
+    for (simd_level level: levels){
+        codec::set_simd_level(level);
+        for (unsigned int e=0;e<N_ENCODINGS;e++){
+            for (const std::string & s: inputs[e]){
+                BOOST_CHECK(pack(encodings[e],s)==pack_reference(encodings[e],s));
+            }
+        }
+    }
+    codec::set_simd_level(ini_level);
+};
+
+BOOST_AUTO_TEST_CASE( pack_invalid_char )
+{
+    simd_level levels[3]={simd_NONE,simd_SSE42,simd_AVX2};
+    const simd_level ini_level=codec::get_simd_level();
+    for (simd_level level: levels){
+        codec::set_simd_level(level);
+        for (unsigned int e=0;e<N_ENCODINGS;e++){
+            for (std::size_t pos: {std::size_t(0),std::size_t(20),std::size_t(999)}){
+                std::string s=inputs[e].back();
+                s[pos]='#';
+                BOOST_CHECK_THROW(pack(encodings[e],s),std::invalid_argument);
+            }
+        }
+        BOOST_CHECK_THROW(pack(NUC_2BITS,"ACGTN"),std::invalid_argument);
+        BOOST_CHECK_THROW(pack(NUC_3BITS,"ACGTNR"),std::invalid_argument);
+        BOOST_CHECK_THROW(pack(PRO_5BITS,"MKVLAAGIJ"),std::invalid_argument);
+    }
+    codec::set_simd_level(ini_level);
+};
+
+BOOST_AUTO_TEST_CASE( pack_prefix_classes )
+{
+    simd_level levels[3]={simd_NONE,simd_SSE42,simd_AVX2};
+    const simd_level ini_level=codec::get_simd_level();
+    for (simd_level level: levels){
+        codec::set_simd_level(level);
+        std::string s=inputs[0].back();
+        std::vector<std::byte> r(codec::packed_size(NUC_4BITS,s.size()));
+        uint8_t classes=0;
+        BOOST_CHECK(codec::pack_prefix(NUC_2BITS,s.data(),s.size(),r.data(),classes)==s.size());
+        BOOST_CHECK(classes==class_NUC_2BITS);
+        r.resize(codec::packed_size(NUC_2BITS,s.size()));
+        BOOST_CHECK(r==pack_reference(NUC_2BITS,s));
+        r.resize(codec::packed_size(NUC_4BITS,s.size()));
+        s[203]='n';
+        classes=0;
+        BOOST_CHECK(codec::pack_prefix(NUC_2BITS,s.data(),s.size(),r.data(),classes)==200);
+        BOOST_CHECK(classes==class_NUC_2BITS);
+        s[999]='E';
+        classes=0;
+        BOOST_CHECK(codec::pack_prefix(NUC_4BITS,s.data(),s.size(),r.data(),classes)==992);
+        BOOST_CHECK(classes==(class_NUC_2BITS | class_NUC_3BITS));
+    }
+    codec::set_simd_level(ini_level);
+    BOOST_CHECK(codec::classify("ACGU",4)==(class_NUC_2BITS | class_RNA));
+    BOOST_CHECK(codec::encoding_of(codec::classify("ACGU",4))==NUC_2BITS);
+    BOOST_CHECK(codec::encoding_of(codec::classify("ac-t",4))==NUC_3BITS);
+    BOOST_CHECK(codec::encoding_of(codec::classify("ACdT",4))==NUC_4BITS);
+    BOOST_CHECK(codec::encoding_of(codec::classify("AC*T",4))==PRO_5BITS);
+    BOOST_CHECK(codec::encoding_of(codec::classify("ACjT",4))==enc_UNDEFINED);
+};
+
+BOOST_AUTO_TEST_CASE( widen )
+{
+    for (unsigned int from=0;from<N_ENCODINGS;from++){
+        for (unsigned int to=from;to<N_ENCODINGS;to++){
+            for (const std::string & s: inputs[from]){
+                std::vector<std::byte> packed=pack(encodings[from],s);
+                std::vector<std::byte> wide(codec::packed_size(encodings[to],s.size()));
+                codec::widen(encodings[from],encodings[to],packed.data(),s.size(),wide.data());
+                // the decoded chars of the narrow encoding give the wide codes
+                std::string narrow(s.size(),'\0');
+                codec::unpack(encodings[from],packed.data(),0,s.size(),narrow.data(),false,decoded[from].data());
+                BOOST_CHECK(wide==pack(encodings[to],narrow));
+                // in place
+                packed.resize(wide.size());
+                codec::widen(encodings[from],encodings[to],packed.data(),s.size(),packed.data());
+                BOOST_CHECK(packed==wide);
+            }
+        }
+    }
+    std::vector<std::byte> packed=pack(NUC_4BITS,"ACGT");
+    BOOST_CHECK_THROW(codec::widen(NUC_4BITS,NUC_2BITS,packed.data(),4,packed.data()),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( extract )
+{
+    for (unsigned int e=0;e<N_ENCODINGS;e++){
+        for (const std::string & s: inputs[e]){
+            std::vector<std::byte> packed=pack(encodings[e],s);
+            for (std::size_t pos: {std::size_t(0),std::size_t(1),std::size_t(5),std::size_t(13)}){
+                if (pos>s.size()) continue;
+                for (std::size_t n: {s.size()-pos,(s.size()-pos)/3}){
+                    std::vector<std::byte> r(codec::packed_size(encodings[e],n),std::byte(0xFF));
+                    codec::extract(encodings[e],packed.data(),pos,n,r.data());
+                    BOOST_CHECK(r==pack(encodings[e],s.substr(pos,n)));
+                }
+            }
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE( reverse )
+{
+    simd_level levels[3]={simd_NONE,simd_SSE42,simd_AVX2};
+    const simd_level ini_level=codec::get_simd_level();
+    for (simd_level level: levels){
+        codec::set_simd_level(level);
+        for (unsigned int e=0;e<N_ENCODINGS;e++){
+            for (const std::string & s: inputs[e]){
+                std::vector<std::byte> packed=pack(encodings[e],s);
+                for (std::size_t pos: {std::size_t(0),std::size_t(1),std::size_t(6),std::size_t(13)}){
+                    if (pos>s.size()) continue;
+                    for (std::size_t n: {s.size()-pos,(s.size()-pos)/3,(s.size()-pos)/2}){
+                        std::vector<std::byte> r(codec::packed_size(encodings[e],n),std::byte(0xFF));
+                        codec::reverse(encodings[e],packed.data(),pos,n,r.data());
+                        std::string expected=s.substr(pos,n);
+                        BOOST_CHECK(r==pack(encodings[e],std::string(expected.rbegin(),expected.rend())));
+                    }
+                }
+            }
+        }
+    }
+    codec::set_simd_level(ini_level);
+};
+
+BOOST_AUTO_TEST_CASE( unpack_range )
+{
+    simd_level levels[3]={simd_NONE,simd_SSE42,simd_AVX2};
+    const simd_level ini_level=codec::get_simd_level();
+    for (simd_level level: levels){
+        codec::set_simd_level(level);
+        for (unsigned int e=0;e<N_ENCODINGS;e++){
+            for (const std::string & s: inputs[e]){
+                std::string upper(s);
+                for (char & c: upper) c=toupper(c);
+                std::vector<std::byte> packed=pack(encodings[e],s);
+                for (std::size_t pos: {std::size_t(0),std::size_t(3),std::size_t(9)}){
+                    if (pos>s.size()) continue;
+                    for (std::size_t n: {s.size()-pos,(s.size()-pos)/2}){
+                        std::string fwd(n,'\0');
+                        std::string rev(n,'\0');
+                        codec::unpack(encodings[e],packed.data(),pos,n,fwd.data(),false,decoded[e].data());
+                        codec::unpack(encodings[e],packed.data(),pos,n,rev.data(),true,decoded[e].data());
+                        std::string expected=upper.substr(pos,n);
+                        BOOST_CHECK(fwd==expected);
+                        BOOST_CHECK(rev==std::string(expected.rbegin(),expected.rend()));
+                    }
+                }
+            }
+        }
+    }
+    codec::set_simd_level(ini_level);
+};
+
+BOOST_AUTO_TEST_CASE( parallel_chunks )
+{
+    const unsigned int ini_threads=codec::get_n_threads();
+    const std::size_t ini_chunk=codec::get_chunk_size();
+    BOOST_CHECK(codec::set_chunk_size(13)==16);
+    BOOST_CHECK(codec::set_n_threads(0)>=1);
+    for (unsigned int e=0;e<N_ENCODINGS;e++){
+        const std::string & s=inputs[e].back();
+        codec::set_n_threads(1);
+        std::vector<std::byte> serial=pack(encodings[e],s);
+        std::string upper(s);
+        for (char & c: upper) c=toupper(c);
+        for (std::size_t chunk: {8,24,64,1000}){
+            codec::set_chunk_size(chunk);
+            codec::set_n_threads(4);
+            // bytes identical to the serial path, elements read across chunks
+            BOOST_CHECK(pack(encodings[e],s)==serial);
+            for (std::size_t pos: {std::size_t(0),std::size_t(5),std::size_t(17)}){
+                const std::size_t n=s.size() - pos - 3;
+                std::string fwd(n,'\0'),rev(n,'\0');
+                codec::unpack(encodings[e],serial.data(),pos,n,fwd.data(),false,decoded[e].data());
+                codec::unpack(encodings[e],serial.data(),pos,n,rev.data(),true,decoded[e].data());
+                const std::string expected=upper.substr(pos,n);
+                BOOST_CHECK(fwd==expected);
+                BOOST_CHECK(rev==std::string(expected.rbegin(),expected.rend()));
+            }
+            // the error of the first invalid char, as raised serially
+            std::string invalid=s;
+            invalid[900]='#';
+            invalid[100]='%';
+            try {
+                pack(encodings[e],invalid);
+                BOOST_CHECK(false);
+            } catch (const std::invalid_argument & error){
+                BOOST_CHECK(std::string(error.what()).find('%')!=std::string::npos);
+            }
+        }
+    }
+    codec::set_n_threads(1);
+    const uint8_t serial_classes=codec::classify(inputs[3].back().data(),inputs[3].back().size());
+    codec::set_n_threads(4);
+    BOOST_CHECK(codec::classify(inputs[3].back().data(),inputs[3].back().size())==serial_classes);
+    codec::set_chunk_size(ini_chunk);
+    codec::set_n_threads(ini_threads);
+};
+
+BOOST_AUTO_TEST_CASE( parallel_callers )
+{
+    const unsigned int ini_threads=codec::get_n_threads();
+    const std::size_t ini_chunk=codec::get_chunk_size();
+    const std::string & s=inputs[2].back();
+    codec::set_n_threads(1);
+    const std::vector<std::byte> serial=pack(NUC_4BITS,s);
+    codec::set_chunk_size(8);
+    codec::set_n_threads(4);
+    // callers on their own threads share the extra threads while the settings change
+    std::vector<std::thread> callers;
+    std::vector<char> same(8,0);
+    for (unsigned int t=0;t<same.size();t++){
+        callers.emplace_back([&,t](){
+            bool ok=true;
+            for (unsigned int i=0;i<20;i++) ok=ok && pack(NUC_4BITS,s)==serial;
+            same[t]=ok;
+        });
+    }
+    for (unsigned int i=0;i<50;i++){
+        codec::set_n_threads(1 + i % 4);
+        codec::set_chunk_size(8 + 8 * (i % 3));
+    }
+    for (std::thread & th: callers) th.join();
+    for (unsigned int t=0;t<same.size();t++) BOOST_CHECK(same[t]);
+    codec::set_chunk_size(ini_chunk);
+    codec::set_n_threads(ini_threads);
+};
+
+BOOST_AUTO_TEST_CASE( policy_get_code )
+{
+    for (unsigned int e=0;e<N_ENCODINGS;e++){
+        const std::string & s=inputs[e].back();
+        std::vector<std::byte> packed=pack(encodings[e],s);
+        std::string r=codec::visit(encodings[e],[&packed,&s](auto policy){
+            using P=decltype(policy);
+            std::string r;
+            for (std::size_t i=0;i<s.size();i++) r.push_back(P::chars[codec::get_code<P>(packed.data(),i)]);
+            return(r);
+        });
+        for (char & c: r) c=tolower(c);
+        std::string lower(s);
+        for (char & c: lower) c=tolower(c);
+        BOOST_CHECK(r==lower);
+    }
+    BOOST_CHECK_THROW(codec::visit(enc_UNDEFINED,[](auto policy){return policy.nbits;}),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( pack_throughput )
+{
+    std::string s;
+    for (unsigned int i=0;i<(1<<10);i++) s+=inputs[0][7];
+    for (unsigned int e=0;e<N_ENCODINGS;e++){
+        auto start=std::chrono::steady_clock::now();
+        std::vector<std::byte> ref=pack_reference(encodings[e],s);
+        std::chrono::duration<double> t_ref=std::chrono::steady_clock::now()-start;
+        start=std::chrono::steady_clock::now();
+        std::vector<std::byte> bulk=pack(encodings[e],s);
+        std::chrono::duration<double> t_bulk=std::chrono::steady_clock::now()-start;
+        BOOST_CHECK(bulk==ref);
+        BOOST_TEST_MESSAGE( (int) codec::nbits(encodings[e]) << "-bits: per-char " << s.size()/t_ref.count()/1e6 << " Mbases/s, bulk " << s.size()/t_bulk.count()/1e6 << " Mbases/s" );
+        BOOST_WARN(t_bulk<t_ref);
+    }
+};
+
+BOOST_AUTO_TEST_CASE( unpack_throughput )
+{
+    std::string s;
+    for (unsigned int i=0;i<(1<<10);i++) s+=inputs[2][7];
+    std::vector<std::byte> packed=pack(NUC_4BITS,s);
+    std::string r(s.size(),'\0');
+    for (bool rev: {false,true}){
+        auto start=std::chrono::steady_clock::now();
+        codec::unpack(NUC_4BITS,packed.data(),0,s.size(),r.data(),rev,decoded[2].data());
+        std::chrono::duration<double> t=std::chrono::steady_clock::now()-start;
+        BOOST_TEST_MESSAGE( "4-bits unpack (rev=" << rev << "): " << s.size()/t.count()/1e6 << " Mbases/s" );
+    }
+};
+
+BOOST_AUTO_TEST_SUITE_END();
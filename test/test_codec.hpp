@@ -0,0 +1,30 @@
+/*
+ * test_codec.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_CODEC_HPP_
+#define TEST_CODEC_HPP_
+
+#include <codec.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::codec"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#define N_ENCODINGS 4
+#define N_LENGTHS 9
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	// ~TestFixture1(); not needed
+
+	std::vector<std::string> inputs[N_ENCODINGS]; /**< random mixed-case inputs of various lengths for each encoding */
+};
+
+#endif /* TEST_CODEC_HPP_ */
@@ -0,0 +1,150 @@
+/*
+ * test_distance.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_distance.hpp>
+#include <random>
+
+using namespace cppbio;
+
+std::string alphabets[N_INPUTS]={"ACGT","ACGTN","ACGTRYKMSWBDHVN","ACDEFGHIKLMNPQRSTVWY"};
+
+uint64_t naive(const std::string & a,const std::string & b){
+    uint64_t r=0;
+    for (std::size_t i=0;i<a.size();i++) r+=(a[i]!=b[i]);
+    return(r);
+};
+
+std::string reverse_complement(const std::string & s){
+    std::string r(s.rbegin(),s.rend());
+    for (char & c: r) c=codec::complement(c);
+    return(r);
+};
+
+TestFixture1::TestFixture1(){
+    std::mt19937 gen(5);
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        std::uniform_int_distribution<std::size_t> pick(0,alphabets[i].size()-1);
+        for (std::size_t j=0;j<301;j++) inputs[i].push_back(alphabets[i][pick(gen)]);
+        mutated[i]=inputs[i];
+        for (std::size_t j=0;j<301;j+=1 + pick(gen)) mutated[i][j]=alphabets[i][pick(gen)];
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_distance, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( pairwise )
+{
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint32_t> a(inputs[i]),b(mutated[i]);
+        const uint64_t d=naive(inputs[i],mutated[i]);
+        BOOST_CHECK(d>0);
+        BOOST_CHECK(hamming(a,b)==d);
+        BOOST_CHECK(hamming(a,a)==0);
+        BOOST_CHECK(mismatches_up_to(a,b,d)==d);
+        BOOST_CHECK(mismatches_up_to(a,b,d-1)==d);
+        BOOST_CHECK(mismatches_up_to(a,b,2)==3);
+        // regions that do not start on a byte
+        for (uint32_t start: {1,3,5,13}){
+            BOOST_CHECK(hamming(a.subseq(start,200),b.subseq(start,200))==naive(inputs[i].substr(start,200),mutated[i].substr(start,200)));
+            BOOST_CHECK(hamming(a.subseq(start,200),b.subseq(start + 2,200))==naive(inputs[i].substr(start,200),mutated[i].substr(start + 2,200)));
+        }
+        if (i==3) continue;
+        // orientation and complement of each side
+        std::string rc=reverse_complement(mutated[i]);
+        seq<uint32_t> c(rc);
+        c.reverse_complement();
+        BOOST_CHECK(hamming(a,c)==d);
+        a.reverse_complement();
+        BOOST_CHECK(hamming(a,b)==naive(reverse_complement(inputs[i]),mutated[i]));
+        BOOST_CHECK(hamming(b,a)==naive(reverse_complement(inputs[i]),mutated[i]));
+    }
+    // encodings of different widths
+    seq<uint32_t> narrow(inputs[0]),wide(inputs[2]);
+    BOOST_CHECK(hamming(narrow,wide)==naive(inputs[0],inputs[2]));
+    BOOST_CHECK(hamming(wide,narrow)==naive(inputs[0],inputs[2]));
+    seq<uint32_t> protein(inputs[3]);
+    BOOST_CHECK_THROW(hamming(narrow,protein),std::invalid_argument);
+    BOOST_CHECK_THROW(hamming(narrow,narrow.subseq(0,10)),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( barcodes )
+{
+    std::mt19937 gen(9);
+    for (std::size_t length: {12,16,33,70}){
+        for (unsigned int i=0;i<3;i++){
+            std::uniform_int_distribution<std::size_t> pick(0,alphabets[i].size()-1);
+            std::vector<std::string> strings;
+            std::vector<seq<uint16_t>> seqs;
+            for (unsigned int j=0;j<23;j++){
+                std::string s;
+                for (std::size_t k=0;k<length;k++) s.push_back(alphabets[0][pick(gen) % 4]);
+                strings.push_back(s);
+                seqs.emplace_back(s);
+            }
+            // one barcode needs the widest encoding, one is stored reversed
+            std::string wide(length,"TNV"[i]);
+            strings.push_back(wide);
+            seqs.emplace_back(wide);
+            std::string rc=reverse_complement(strings[0]);
+            strings.push_back(strings[0]);
+            seqs.emplace_back(rc);
+            seqs.back().reverse_complement();
+            std::string query;
+            for (std::size_t k=0;k<length;k++) query.push_back(alphabets[i][pick(gen)]);
+            std::vector<uint32_t> expected;
+            for (const std::string & s: strings) expected.push_back(naive(query,s));
+            for (simd_level level: {simd_NONE,simd_AVX2}){
+                codec::set_simd_level(level);
+                barcode_set<uint16_t> set(seqs);
+                BOOST_CHECK(set.size()==strings.size());
+                seq<uint16_t> q(query);
+                BOOST_CHECK(set.hamming(q)==expected);
+                std::vector<std::size_t> close=set.within(seq<uint16_t>(strings[5]),1);
+                BOOST_CHECK(std::find(close.begin(),close.end(),5)!=close.end());
+            }
+            codec::set_simd_level(simd_AVX2);
+        }
+    }
+    // queries wider than the barcodes: their extra chars mismatch every barcode
+    for (std::size_t length: {12,33,70}){
+        std::uniform_int_distribution<std::size_t> pick(0,3);
+        std::vector<std::string> strings;
+        std::vector<seq<uint16_t>> seqs;
+        for (unsigned int j=0;j<23;j++){
+            std::string s;
+            for (std::size_t k=0;k<length;k++) s.push_back("ACGT"[pick(gen)]);
+            strings.push_back(s);
+            seqs.emplace_back(s);
+        }
+        std::string query=strings[7];
+        query[length / 2]='N';
+        query[length - 1]='R';
+        for (simd_level level: {simd_NONE,simd_AVX2}){
+            codec::set_simd_level(level);
+            barcode_set<uint16_t> set(seqs);
+            std::vector<uint32_t> expected;
+            for (const std::string & s: strings) expected.push_back(naive(query,s));
+            BOOST_CHECK(set.hamming(seq<uint16_t>(query))==expected);
+            BOOST_CHECK(set.hamming(seq<uint16_t>(query))[7]==2);
+            seq<uint16_t> rc(reverse_complement(query));
+            rc.reverse_complement();
+            BOOST_CHECK(set.hamming(rc)==expected);
+            BOOST_CHECK(set.within(seq<uint16_t>(query),2)==std::vector<std::size_t>(1,7));
+        }
+        codec::set_simd_level(simd_AVX2);
+    }
+    std::string protein_s="MKDLQE",short_s="ACG",long_s="ACGTAC";
+    std::vector<seq<uint16_t>> seqs {seq<uint16_t>(long_s)};
+    barcode_set<uint16_t> set(seqs);
+    BOOST_CHECK_THROW(set.hamming(seq<uint16_t>(short_s)),std::invalid_argument);
+    BOOST_CHECK_THROW(set.hamming(seq<uint16_t>(protein_s)),std::invalid_argument);
+    seqs.emplace_back(short_s);
+    BOOST_CHECK_THROW(barcode_set<uint16_t> invalid(seqs),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_SUITE_END();
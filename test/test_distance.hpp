@@ -0,0 +1,30 @@
+/*
+ * test_distance.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_DISTANCE_HPP_
+#define TEST_DISTANCE_HPP_
+
+#include <distance.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::hamming"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#define N_INPUTS 4
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	// ~TestFixture1(); not needed
+
+	std::string inputs[N_INPUTS]; /**< random sequences of 2, 3, 4 and 5 bits alphabets */
+	std::string mutated[N_INPUTS]; /**< the inputs with random substitutions */
+};
+
+#endif /* TEST_DISTANCE_HPP_ */
@@ -0,0 +1,166 @@
+/*
+ * test_fastx.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_fastx.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace cppbio;
+
+std::string fasta=
+    ">chr1 first contig\n"
+    "ACGTACGTAC\n"
+    "GTNNACGT\n"
+    "\n"
+    ">chr2\r\n"
+    "ACGT\r\n"
+    ">empty\n"
+    ">chr3\tlast\n"
+    "RYKM";
+
+std::string fastq=
+    "@read1 1:N:0\n"
+    "ACGTN\n"
+    "+\n"
+    "@@+II\n"
+    "@read2\n"
+    "ACG\n"
+    "TT\n"
+    "+read2\n"
+    "II\n"
+    "@I#\n";
+
+struct expected_record {
+    std::string name;
+    std::string comment;
+    std::string sequence;
+    std::string quality;
+};
+
+std::vector<expected_record> fasta_records={
+    {"chr1","first contig","ACGTACGTACGTNNACGT",""},
+    {"chr2","","ACGT",""},
+    {"empty","","",""},
+    {"chr3","last","RYKM",""}
+};
+
+std::vector<expected_record> fastq_records={
+    {"read1","1:N:0","ACGTN","@@+II"},
+    {"read2","","ACGTT","II@I#"}
+};
+
+TestFixture1::TestFixture1(){};
+
+TestFixture1::~TestFixture1(){
+    for (const std::string & path: paths) std::remove(path.c_str());
+};
+
+std::string TestFixture1::write_file(const std::string & content){
+    char path[]="/tmp/test_fastx_XXXXXX";
+    int fd=mkstemp(path);
+    BOOST_REQUIRE(fd>=0);
+    BOOST_REQUIRE(write(fd,content.data(),content.size())==(ssize_t) content.size());
+    close(fd);
+    paths.push_back(path);
+    return(path);
+};
+
+// Read the whole input with a reader and compare its records
+void check_records(fastx_reader & reader, const std::vector<expected_record> & expected){
+    fastx_record r;
+    for (const expected_record & e: expected){
+        BOOST_REQUIRE(reader.next(r));
+        BOOST_CHECK(r.name==e.name);
+        BOOST_CHECK(r.comment==e.comment);
+        BOOST_CHECK(r.sequence==e.sequence);
+        BOOST_CHECK(r.quality==e.quality);
+    }
+    BOOST_CHECK(!reader.next(r));
+    BOOST_CHECK(!reader.next(r));
+};
+
+// Reader on a pipe, so that the input is read in blocks of block_size bytes
+void check_pipe(const std::string & content, std::size_t block_size, fastx_format format, const std::vector<expected_record> & expected){
+    int fds[2];
+    BOOST_REQUIRE(pipe(fds)==0);
+    BOOST_REQUIRE(write(fds[1],content.data(),content.size())==(ssize_t) content.size());
+    close(fds[1]);
+    {
+        fastx_reader reader("/dev/fd/" + std::to_string(fds[0]),block_size);
+        BOOST_CHECK(reader.get_format()==format);
+        check_records(reader,expected);
+    }
+    close(fds[0]);
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_fastx, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( mapped_fasta )
+{
+    simd_level levels[3]={simd_NONE,simd_SSE42,simd_AVX2};
+    const simd_level ini_level=codec::get_simd_level();
+    for (simd_level level: levels){
+        codec::set_simd_level(level);
+        fastx_reader reader(write_file(fasta));
+        BOOST_CHECK(reader.get_format()==FASTA);
+        check_records(reader,fasta_records);
+    }
+    codec::set_simd_level(ini_level);
+};
+
+BOOST_AUTO_TEST_CASE( mapped_fastq )
+{
+    fastx_reader reader(write_file("\n" + fastq));
+    BOOST_CHECK(reader.get_format()==FASTQ);
+    check_records(reader,fastq_records);
+};
+
+BOOST_AUTO_TEST_CASE( streamed )
+{
+    for (std::size_t block_size: {std::size_t(1),std::size_t(7),std::size_t(64),std::size_t(1 << 16)}){
+        check_pipe(fasta,block_size,FASTA,fasta_records);
+        check_pipe(fastq,block_size,FASTQ,fastq_records);
+    }
+};
+
+BOOST_AUTO_TEST_CASE( long_records )
+{
+    std::string s;
+    for (unsigned int i=0;i<10000;i++) s.push_back("ACGT"[i % 4]);
+    std::string content;
+    std::vector<expected_record> expected;
+    for (unsigned int i=0;i<5;i++){ // less than the 64 KiB of a pipe buffer
+        content+=">seq" + std::to_string(i) + "\n";
+        for (std::size_t j=0;j<s.size();j+=60) content+=s.substr(j,60) + "\n";
+        expected.push_back({"seq" + std::to_string(i),"",s,""});
+    }
+    fastx_reader reader(write_file(content));
+    check_records(reader,expected);
+    check_pipe(content,1000,FASTA,expected);
+};
+
+BOOST_AUTO_TEST_CASE( malformed )
+{
+    fastx_record r;
+    BOOST_CHECK_THROW(fastx_reader reader("/tmp/test_fastx_missing"),std::runtime_error);
+    BOOST_CHECK_THROW(fastx_reader reader(write_file("ACGT\n")),std::invalid_argument);
+    fastx_reader empty(write_file(""));
+    BOOST_CHECK(empty.get_format()==fmt_UNDEFINED);
+    BOOST_CHECK(!empty.next(r));
+    fastx_reader no_plus(write_file("@read\nACGT\n"));
+    BOOST_CHECK_THROW(no_plus.next(r),std::invalid_argument);
+    fastx_reader short_quality(write_file("@read\nACGT\n+\nII\n"));
+    BOOST_CHECK_THROW(short_quality.next(r),std::invalid_argument);
+    fastx_reader mixed(write_file(">read\nACGT\n@read\n"));
+    BOOST_CHECK(mixed.next(r));
+    BOOST_CHECK(r.sequence=="ACGT@read");
+};
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,29 @@
+/*
+ * test_fastx.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_FASTX_HPP_
+#define TEST_FASTX_HPP_
+
+#include <fastx.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::fastx_reader"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	~TestFixture1();
+
+	std::vector<std::string> paths; /**< temporary files written by write_file */
+
+	std::string write_file(const std::string & content);
+};
+
+#endif /* TEST_FASTX_HPP_ */
@@ -0,0 +1,114 @@
+/*
+ * test_kmer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_kmer.hpp>
+#include <algorithm>
+#include <random>
+
+using namespace cppbio;
+
+// k-mers of a string: position, forward and reverse complement codes, skipping non-ACGT windows
+template<typename T_kmer>
+std::vector<kmer<T_kmer>> kmers_reference(const std::string & s, uint8_t k){
+    const std::string bases="ACGT";
+    std::vector<kmer<T_kmer>> r;
+    for (std::size_t i=0;i+k<=s.size();i++){
+        kmer<T_kmer> m {i,0,0};
+        bool valid=true;
+        for (std::size_t j=0;j<k;j++){
+            std::size_t c=bases.find(s[i+j]);
+            std::size_t rc=bases.find(s[i+k-1-j]);
+            if (c==std::string::npos || rc==std::string::npos){ valid=false; break; }
+            m.forward=(m.forward << 2) | T_kmer(c);
+            m.reverse=(m.reverse << 2) | T_kmer(3-rc);
+        }
+        if (valid) r.push_back(m);
+    }
+    return(r);
+};
+
+template<typename T_kmer>
+bool same_kmers(const kmers<uint32_t,T_kmer> & range, const std::vector<kmer<T_kmer>> & expected){
+    std::size_t i=0;
+    for (const kmer<T_kmer> & m: range){
+        if (i>=expected.size() || m.pos!=expected[i].pos || m.forward!=expected[i].forward || m.reverse!=expected[i].reverse) return(false);
+        i++;
+    }
+    return(i==expected.size());
+};
+
+TestFixture1::TestFixture1(){
+    std::mt19937 gen(7);
+    const std::string alphabets[N_INPUTS]={"ACGT","ACGTTTTTN","ACGTGCAAAATTTTTR","ACGT"};
+    const std::size_t lengths[N_INPUTS]={300,300,300,5};
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        std::uniform_int_distribution<std::size_t> pick(0,alphabets[i].size()-1);
+        for (std::size_t j=0;j<lengths[i];j++) inputs[i].push_back(alphabets[i][pick(gen)]);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_kmer, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( forward_and_reverse )
+{
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint32_t> s(inputs[i]);
+        for (uint8_t k: {1,5,16}){
+            BOOST_CHECK(same_kmers(kmers<uint32_t,uint32_t>(s,k),kmers_reference<uint32_t>(inputs[i],k)));
+        }
+        for (uint8_t k: {1,5,21,31,32}){
+            BOOST_CHECK(same_kmers(kmers<uint32_t>(s,k),kmers_reference<uint64_t>(inputs[i],k)));
+        }
+        for (uint8_t k: {33,47,64}){
+            BOOST_CHECK(same_kmers(kmers<uint32_t,uint128_t>(s,k),kmers_reference<uint128_t>(inputs[i],k)));
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE( orientation )
+{
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint32_t> s(inputs[i]);
+        s.reverse_complement();
+        const std::string rc=s.get_string();
+        BOOST_CHECK(same_kmers(kmers<uint32_t>(s,11),kmers_reference<uint64_t>(rc,11)));
+        s.reverse();
+        BOOST_CHECK(same_kmers(kmers<uint32_t>(s,11),kmers_reference<uint64_t>(s.get_string(),11)));
+        seq<uint32_t> region=s.subseq(3,s.size()>3 ? s.size()-5 : 0);
+        BOOST_CHECK(same_kmers(kmers<uint32_t>(region,7),kmers_reference<uint64_t>(region.get_string(),7)));
+    }
+};
+
+BOOST_AUTO_TEST_CASE( canonical )
+{
+    seq<uint32_t> s(inputs[0]);
+    seq<uint32_t> rc(inputs[0]);
+    rc.reverse_complement();
+    std::vector<uint64_t> a,b;
+    for (const kmer<uint64_t> & m: kmers<uint32_t>(s,21)) a.push_back(m.canonical());
+    for (const kmer<uint64_t> & m: kmers<uint32_t>(rc,21)) b.push_back(m.canonical());
+    std::sort(a.begin(),a.end());
+    std::sort(b.begin(),b.end());
+    BOOST_CHECK(a.size()==inputs[0].size()-20);
+    BOOST_CHECK(a==b);
+};
+
+BOOST_AUTO_TEST_CASE( invalid )
+{
+    seq<uint32_t> s(inputs[0]);
+    BOOST_CHECK_THROW(kmers<uint32_t>(s,0),std::invalid_argument);
+    BOOST_CHECK_THROW(kmers<uint32_t>(s,33),std::invalid_argument);
+    std::string protein="MKDLQE";
+    seq<uint32_t> p(protein);
+    BOOST_CHECK_THROW(kmers<uint32_t>(p,3),std::invalid_argument);
+    seq<uint32_t> empty;
+    kmers<uint32_t> none(empty,3);
+    BOOST_CHECK(none.begin()==none.end());
+};
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,29 @@
+/*
+ * test_kmer.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_KMER_HPP_
+#define TEST_KMER_HPP_
+
+#include <kmer.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::kmers"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#define N_INPUTS 4
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	// ~TestFixture1(); not needed
+
+	std::string inputs[N_INPUTS]; /**< random sequences of 2, 3 and 4 bits alphabets */
+};
+
+#endif /* TEST_KMER_HPP_ */
@@ -0,0 +1,106 @@
+/*
+ * test_kmer_count.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_kmer_count.hpp>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+using namespace cppbio;
+
+#define K 11
+
+std::string reverse_complement(const std::string & s){
+    std::string r(s.rbegin(),s.rend());
+    for (char & c: r) c=codec::complement(c);
+    return(r);
+};
+
+TestFixture1::TestFixture1(){
+    std::mt19937 gen(13);
+    // a small alphabet of k-mers so that counts are above 1
+    const std::string genome_alphabet="ACGT";
+    std::string genome;
+    std::uniform_int_distribution<std::size_t> base(0,3);
+    for (std::size_t j=0;j<500;j++) genome.push_back(genome_alphabet[base(gen)]);
+    std::uniform_int_distribution<std::size_t> start(0,genome.size()-100);
+    std::uniform_int_distribution<std::size_t> coin(0,9);
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        std::string read=genome.substr(start(gen),20 + coin(gen) * 8);
+        if (coin(gen)==0) read[read.size() / 2]='N';
+        inputs.push_back(read);
+        seq<uint32_t> s(read);
+        if (coin(gen)<3) s.reverse_complement();
+        seqs.push_back(s);
+        for (std::size_t j=0;j+K<=read.size();j++){
+            const std::string m=read.substr(j,K);
+            if (m.find('N')!=std::string::npos) continue;
+            const std::string rc=reverse_complement(m);
+            expected[std::min(m,rc)]++;
+        }
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_kmer_count, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( counts )
+{
+    for (unsigned int n_threads: {1,3,8}){
+        kmer_counter<uint32_t> counter(K,n_threads);
+        counter.add(seqs);
+        BOOST_CHECK(counter.size()==expected.size());
+        bool same=true;
+        for (const auto & [m,c]: expected){
+            same=same && counter.count(m)==c && counter.count(reverse_complement(m))==c;
+        }
+        BOOST_CHECK(same);
+        BOOST_CHECK(counter.count("ACGTNACGTAC")==0);
+        BOOST_CHECK(counter.count("ACG")==0);
+    }
+};
+
+BOOST_AUTO_TEST_CASE( accumulate_and_spill )
+{
+    kmer_counter<uint32_t,uint128_t> in_memory(K,2);
+    std::vector<seq<uint32_t>> half(seqs.begin(),seqs.begin() + N_INPUTS / 2);
+    in_memory.add(half);
+    for (std::size_t i=N_INPUTS / 2;i<N_INPUTS;i++) in_memory.add(seqs[i]);
+
+    const char * tmp=std::getenv("TMPDIR");
+    // 7 codes per buffer of the 4 threads x 16 partitions
+    kmer_counter<uint32_t,uint128_t> spilled(K,4,tmp ? tmp : "/tmp",7 * 4 * 16);
+    spilled.add(seqs);
+
+    BOOST_CHECK(in_memory.histogram()==spilled.histogram());
+    // full buffers merged while counting
+    kmer_counter<uint32_t,uint128_t> merged(K,4,"",7 * 4 * 16);
+    merged.add(seqs);
+    BOOST_CHECK(in_memory.histogram()==merged.histogram());
+    std::map<uint64_t,uint64_t> h;
+    for (const auto & [m,c]: expected) h[c]++;
+    BOOST_CHECK(spilled.histogram()==h);
+
+    std::ostringstream out;
+    spilled.write_histogram(out);
+    std::ostringstream ref;
+    for (const auto & [c,n]: h) ref << c << '\t' << n << '\n';
+    BOOST_CHECK(out.str()==ref.str());
+};
+
+BOOST_AUTO_TEST_CASE( invalid )
+{
+    BOOST_CHECK_THROW(kmer_counter<uint32_t>(0),std::invalid_argument);
+    BOOST_CHECK_THROW(kmer_counter<uint32_t>(33),std::invalid_argument);
+    BOOST_CHECK_THROW(kmer_counter<uint32_t>(K,1,"/nonexistent/dir"),std::runtime_error);
+    std::string protein="MKDLQE";
+    kmer_counter<uint32_t> counter(3,2);
+    BOOST_CHECK_THROW(counter.add(seq<uint32_t>(protein)),std::invalid_argument);
+    BOOST_CHECK(counter.size()==0);
+};
+
+BOOST_AUTO_TEST_SUITE_END();
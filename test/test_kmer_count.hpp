@@ -0,0 +1,32 @@
+/*
+ * test_kmer_count.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_KMER_COUNT_HPP_
+#define TEST_KMER_COUNT_HPP_
+
+#include <kmer_count.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::kmer_counter"
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define N_INPUTS 200
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	// ~TestFixture1(); not needed
+
+	std::vector<std::string> inputs; /**< random reads, some with N */
+	std::vector<seq<uint32_t>> seqs; /**< the encoded reads, some reverse complemented */
+	std::map<std::string,uint64_t> expected; /**< count of each canonical 11-mer */
+};
+
+#endif /* TEST_KMER_COUNT_HPP_ */
@@ -8,6 +8,11 @@
 
 #include <test_seq.hpp>
 #include <tuple>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <map>
+#include <type_traits>
 
 using namespace cppbio;
 
@@ -184,4 +189,559 @@ BOOST_AUTO_TEST_CASE( reverse_complement )
 	};
 };
 
+BOOST_AUTO_TEST_CASE( copy )
+{
+    std::vector<seq<uint32_t>> copies;
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint32_t> s(inputs[i]);
+        s.reverse();
+        copies.push_back(s);
+    };
+
+    for (unsigned int i=0;i<N_INPUTS;i++){
+    BOOST_CHECK(copies[i].get_string()==revs[i]);
+	};
+};
+
+BOOST_AUTO_TEST_CASE( shared_complement )
+{
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint64_t> s(inputs[i]);
+        seq<uint64_t> copy(s);
+        seq<uint64_t> region=s.subseq(1,5);
+        copy.reverse_complement();
+        region.complement();
+        BOOST_CHECK(s.get_string()==inputs[i]);
+        BOOST_CHECK(copy.get_string()==revcomps[i]);
+        BOOST_CHECK(region.get_string()==comps[i].substr(1,5));
+    };
+};
+
+BOOST_AUTO_TEST_CASE( protein )
+{
+    std::string in_s="MKDLQEWAHIVGG-STXPCFNPRY*!";
+    std::string expected=in_s;
+    seq<uint8_t> s(in_s);
+    BOOST_CHECK(s.get_string()==expected);
+    s.reverse();
+    BOOST_CHECK(s.get_string()==std::string(expected.rbegin(),expected.rend()));
+
+    std::string lower_s="mkdlqe";
+    seq<uint64_t> lower(lower_s);
+    BOOST_CHECK(lower.get_string()=="MKDLQE");
+
+    BOOST_CHECK_THROW(s.complement(),std::invalid_argument);
+    BOOST_CHECK_THROW(s.reverse_complement(),std::invalid_argument);
+
+    std::string invalid_s="MKDLQEJ";
+    BOOST_CHECK_THROW(seq<uint16_t> invalid(invalid_s),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( chars )
+{
+    // e.g. a view on a record of a memory-mapped file
+    const char * record=">id\nAAAANTTT-CCG\n";
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint16_t> s(inputs[i].data(),inputs[i].size());
+        BOOST_CHECK(s.get_string()==inputs[i]);
+    };
+    seq<uint8_t> s(record + 4,12);
+    BOOST_CHECK(s.get_string()==inputs[2]);
+};
+
+BOOST_AUTO_TEST_CASE( subseq )
+{
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint16_t> s(inputs[i]);
+        for (uint16_t start: {0,1,3,7}){
+            for (uint16_t len: {0,1,2,5}){
+                if (start+len>(int) inputs[i].size()) continue;
+                seq<uint16_t> region=s.subseq(start,len);
+                BOOST_CHECK(region.get_string()==inputs[i].substr(start,len));
+                region.reverse_complement();
+                BOOST_CHECK(region.get_string()==revcomps[i].substr(inputs[i].size()-start-len,len));
+                // a region of a region, in the reversed orientation
+                if (len>1) BOOST_CHECK(region.subseq(1,len-2).get_string()==revcomps[i].substr(inputs[i].size()-start-len+1,len-2));
+            };
+        };
+        BOOST_CHECK(s.get_string()==inputs[i]);
+        s.reverse();
+        BOOST_CHECK(s.subseq(2,5).get_string()==revs[i].substr(2,5));
+        BOOST_CHECK_THROW(s.subseq(inputs[i].size()-1,2),std::out_of_range);
+    };
+};
+
+BOOST_AUTO_TEST_CASE( element_access )
+{
+    static_assert(std::random_access_iterator<seq<uint8_t>::const_iterator>);
+    std::string expected[4]={inputs[1],revs[1],revcomps[1],comps[1]};
+    seq<uint16_t> s(inputs[1]);
+    for (unsigned int k=0;k<4;k++){
+        if (k==1) s.reverse();
+        if (k==2) s.complement();
+        if (k==3) s.reverse();
+        std::string r;
+        for (char c: s) r.push_back(c);
+        BOOST_CHECK(r==expected[k]);
+        BOOST_CHECK(std::string(s.begin(),s.end())==expected[k]);
+        for (uint16_t i=0;i<s.size();i++){
+            BOOST_CHECK(s[i]==expected[k][i]);
+            BOOST_CHECK(s.at(i)==expected[k][i]);
+            BOOST_CHECK(s.begin()[i]==expected[k][i]);
+        };
+        BOOST_CHECK(std::count(s.begin(),s.end(),'N')==1);
+        BOOST_CHECK(std::string(std::make_reverse_iterator(s.end()),std::make_reverse_iterator(s.begin()))==std::string(expected[k].rbegin(),expected[k].rend()));
+        BOOST_CHECK_THROW(s.at(s.size()),std::out_of_range);
+    };
+
+    std::string long_s;
+    for (unsigned int i=0;i<1000;i++) long_s.push_back("ACGTN"[(i * i) % 5]);
+    seq<uint32_t> l(long_s);
+    seq<uint32_t> region=l.subseq(13,500);
+    BOOST_CHECK(std::string(region.begin(),region.end())==long_s.substr(13,500));
+    BOOST_CHECK(region.end() - region.begin()==500);
+    BOOST_CHECK(*(region.begin() + 499)==long_s[512]);
+    BOOST_CHECK(std::lower_bound(region.begin(),region.end(),'Z')==region.end());
+};
+
+BOOST_AUTO_TEST_CASE( materialize )
+{
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint8_t> s(inputs[i]);
+        seq<uint8_t> copy(s);
+        s.reverse();
+        s.materialize();
+        BOOST_CHECK(s.get_string()==revs[i]);
+        s.reverse_complement();
+        s.materialize();
+        BOOST_CHECK(s.get_string()==comps[i]);
+        seq<uint8_t> region=copy.subseq(3,6);
+        region.reverse();
+        region.materialize();
+        BOOST_CHECK(region.get_string()==revs[i].substr(inputs[i].size()-9,6));
+        BOOST_CHECK(std::string(region.begin(),region.end())==region.get_string());
+        BOOST_CHECK(copy.get_string()==inputs[i]);
+    };
+};
+
+BOOST_AUTO_TEST_CASE( rna )
+{
+    std::string in_s="ACGUUGCAacgu";
+    seq<uint16_t> s(in_s);
+    BOOST_CHECK(s.get_string()=="ACGUUGCAACGU");
+    s.reverse_complement();
+    BOOST_CHECK(s.get_string()=="ACGUUGCAACGU");
+};
+
+BOOST_AUTO_TEST_CASE( widening )
+{
+    // the alphabet grows along the string, the packed prefix is widened each time
+    std::string in_s(1000,'A');
+    for (std::size_t i=0;i<in_s.size();i++) in_s[i]="ACGT"[(i * 7) % 4];
+    in_s[300]='N';
+    in_s[301]='-';
+    in_s[650]='R';
+    std::string expected=in_s;
+    seq<uint32_t> nuc(in_s);
+    BOOST_CHECK(nuc.get_string()==expected);
+    nuc.reverse();
+    BOOST_CHECK(nuc.get_string()==std::string(expected.rbegin(),expected.rend()));
+
+    in_s[990]='E';
+    expected=in_s;
+    seq<uint32_t> pro(in_s);
+    BOOST_CHECK(pro.get_string()==expected);
+
+    // U and T are one nucleotide code, but two amino-acids
+    const std::string rna_pro=std::string(16,'U') + "E";
+    BOOST_CHECK(seq<uint32_t>(rna_pro).get_string()==rna_pro);
+    std::string mixed;
+    for (std::size_t i=0;i<10;i++) mixed+="ACGUTT";
+    mixed+="E";
+    BOOST_CHECK(seq<uint32_t>(mixed).get_string()==mixed);
+
+    in_s[995]='#';
+    BOOST_CHECK_THROW(seq<uint32_t> invalid(in_s),std::invalid_argument);
+    BOOST_CHECK_THROW(seq<uint8_t> too_long(in_s),std::length_error);
+};
+
+BOOST_AUTO_TEST_CASE( find )
+{
+    seq<uint16_t> s(inputs[0]);
+    BOOST_CHECK(s.find("TTTC")==4);
+    BOOST_CHECK(s.find("tttc")==4);
+    BOOST_CHECK(s.find("AAA",1)==1);
+    BOOST_CHECK(s.find("AAA",2)==seq<uint16_t>::npos);
+    BOOST_CHECK(s.find("GGA")==seq<uint16_t>::npos);
+    // GGA is the reverse complement of TCC
+    BOOST_CHECK(s.find("GGA",0,true)==6);
+    BOOST_CHECK(s.find_all("AAA").size()==2);
+    // R is A or G, N matches any base
+    BOOST_CHECK(s.find("CCR")==7);
+    BOOST_CHECK(s.find("CCR",0,false,false)==seq<uint16_t>::npos);
+    BOOST_CHECK(s.find("TNC")==5);
+
+    seq<uint16_t> gapped(inputs[2]);
+    BOOST_CHECK(gapped.find("T-C")==7);
+    BOOST_CHECK(gapped.find("ANT")==2);
+    BOOST_CHECK(gapped.find("ANT",0,false,false)==3);
+    BOOST_CHECK(gapped.find("AGT")==3);
+    BOOST_CHECK(gapped.find("AGT",0,false,false)==seq<uint16_t>::npos);
+    gapped.reverse_complement();
+    BOOST_CHECK(gapped.find("G-A",0,false,false)==2);
+
+    // long seq, reversed region, both strands against a naive scan
+    std::string long_s;
+    for (unsigned int i=0;i<10000;i++) long_s.push_back("ACGTACGGTTAC"[(i * i + i / 7) % 12]);
+    seq<uint32_t> l(long_s);
+    seq<uint32_t> region=l.subseq(17,9000);
+    region.reverse_complement();
+    const std::string text=region.get_string();
+    const std::string pattern=text.substr(4321,11);
+    std::string rc(pattern.rbegin(),pattern.rend());
+    for (char & c: rc) c=codec::complement(c);
+    std::vector<seq_match> expected;
+    for (std::size_t i=0;i + pattern.size()<=text.size();i++){
+        if (text.compare(i,pattern.size(),pattern)==0) expected.push_back(seq_match {i,false});
+        if (text.compare(i,rc.size(),rc)==0) expected.push_back(seq_match {i,true});
+    };
+    const std::vector<seq_match> found=region.find_all(pattern,true);
+    BOOST_CHECK(expected.size()>0);
+    BOOST_CHECK(found.size()==expected.size());
+    for (std::size_t i=0;i<std::min(found.size(),expected.size());i++){
+        BOOST_CHECK(found[i].pos==expected[i].pos && found[i].reverse==expected[i].reverse);
+    };
+
+    std::string protein_s="MKDLQEWAHIVGG-STXPCFNPRY*!";
+    seq<uint8_t> protein(protein_s);
+    BOOST_CHECK(protein.find("PCF")==17);
+    BOOST_CHECK(protein.find("Y*")==23);
+    BOOST_CHECK(seq<uint32_t>("MKLVWWQQAA").find_all("WW").size()==1);
+    BOOST_CHECK_THROW(seq<uint32_t>("MKLVWWQQAA").find_all("WW",true),std::invalid_argument);
+    BOOST_CHECK_THROW(protein.find("PCF",0,true),std::invalid_argument);
+    BOOST_CHECK_THROW(s.find(""),std::invalid_argument);
+    BOOST_CHECK_THROW(s.find(std::string(65,'A')),std::invalid_argument);
+    BOOST_CHECK_THROW(s.find("ACJ"),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( composition )
+{
+    // naive counts of the chars of a string
+    auto count=[](const std::string & str){
+        std::map<char,uint32_t> r;
+        for (char c: str) r[c]++;
+        return(r);
+    };
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint32_t> s(inputs[i]);
+        BOOST_CHECK(s.composition()==count(inputs[i]));
+        s.complement();
+        BOOST_CHECK(s.composition()==count(comps[i]));
+    };
+
+    // one alphabet per encoding
+    std::vector<std::string> long_inputs;
+    for (const std::string alphabet: {"ACGTTGCAAG","ACGTTGCAAGN","ACGTTGCAAGSWN","MKDLQEWAHIVGG-STXPCFNPRY*"}){
+        std::string long_s;
+        for (unsigned int i=0;i<10000;i++) long_s.push_back(alphabet[(i * i + i / 5) % alphabet.size()]);
+        long_inputs.push_back(long_s);
+    };
+    for (const std::string & in_s: long_inputs){
+        std::string copy=in_s;
+        seq<uint32_t> whole(copy);
+        seq<uint32_t> region=whole.subseq(37,2000);
+        const bool nucleotide=whole.get_m_type()!=PROTEIN;
+        if (nucleotide) region.reverse_complement(); else region.reverse();
+        const std::string text=region.get_string();
+        BOOST_CHECK(whole.composition()==count(in_s));
+        BOOST_CHECK(region.composition()==count(text));
+        for (uint32_t window: {1,50,333}){
+            for (uint32_t step: {1,17,50,400}){
+                std::vector<std::map<char,uint32_t>> windows=region.composition(window,step);
+                bool same=windows.size()==(text.size() - window) / step + 1;
+                for (std::size_t w=0;w<windows.size();w++) same=same && windows[w]==count(text.substr(w * step,window));
+                BOOST_CHECK(same);
+            };
+        };
+        if (!nucleotide) continue;
+        auto gc=[](const std::string & str){
+            double n_gc=0,n_at=0;
+            for (char c: str){
+                if (c=='G' || c=='C' || c=='S') n_gc++;
+                if (c=='A' || c=='T' || c=='W') n_at++;
+            };
+            return(n_gc + n_at ? n_gc / (n_gc + n_at) : 0.0);
+        };
+        BOOST_CHECK_CLOSE(region.gc_content(),gc(text),1e-9);
+        std::vector<double> windows=region.gc_content(100,30);
+        bool same=windows.size()==(text.size() - 100) / 30 + 1;
+        for (std::size_t w=0;w<windows.size();w++) same=same && std::abs(windows[w] - gc(text.substr(w * 30,100)))<1e-9;
+        BOOST_CHECK(same);
+    };
+
+    std::string protein_short="MKDLQE";
+    seq<uint8_t> protein(protein_short);
+    BOOST_CHECK_THROW(protein.gc_content(),std::invalid_argument);
+    seq<uint8_t> s(inputs[0]);
+    BOOST_CHECK(s.gc_content()==0.3);
+    BOOST_CHECK(s.composition(20,1).empty());
+    BOOST_CHECK_THROW(s.composition(0,1),std::invalid_argument);
+    BOOST_CHECK_THROW(s.gc_content(5,0),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( translate )
+{
+    const std::string table="FFLLSSSSYY**CC*WLLLLPPPPHHQQRRRRIIIMTTTTNNKKSSRRVVVVAAAADDEEGGGG";
+    auto naive=[&table](const std::string & str,std::size_t frame){
+        std::string r;
+        auto index=[](char c){ return(std::string("TCAG").find(c)); };
+        std::size_t i=frame;
+        for (;i + 3<=str.size();i+=3) r.push_back(table[index(str[i]) * 16 + index(str[i + 1]) * 4 + index(str[i + 2])]);
+        if (i<str.size()) r.push_back('!');
+        return(r);
+    };
+    auto revcomp=[](const std::string & str){
+        std::string r(str.rbegin(),str.rend());
+        for (char & c: r) c=codec::complement(c);
+        return(r);
+    };
+    std::string text;
+    for (std::size_t i=0;i<301;i++) text.push_back("ACGT"[(i * 7 + i / 5) % 4]);
+    seq<uint32_t> s(text);
+    for (uint32_t start: {0,1,3,6}){
+        for (uint32_t len: {0,2,97,150,295}){
+            seq<uint32_t> region=s.subseq(start,len);
+            const std::string str=text.substr(start,len);
+            std::vector<seq<uint32_t>> frames=region.six_frame();
+            BOOST_CHECK(frames.size()==6);
+            for (uint8_t frame=0;frame<3;frame++){
+                BOOST_CHECK(frames[frame].get_string()==naive(str,frame));
+                BOOST_CHECK(frames[3 + frame].get_string()==naive(revcomp(str),frame));
+                BOOST_CHECK(frames[frame].get_m_type()==PROTEIN);
+            };
+            seq<uint32_t> rev(region);
+            rev.reverse();
+            BOOST_CHECK(rev.translate(1).get_string()==naive(std::string(str.rbegin(),str.rend()),1));
+        };
+    };
+    // ambiguous codons, gaps and frameshifts
+    std::string ambiguous="ATGCTNATNTAR---A-GCC",rna="AUGUAA",protein_short="MKDLQE";
+    BOOST_CHECK(seq<uint16_t>(ambiguous).translate().get_string()=="MLX*-!!");
+    BOOST_CHECK(seq<uint16_t>(ambiguous,NUC_4BITS).translate().get_string()=="MLX*-!!");
+    BOOST_CHECK(seq<uint16_t>(rna).translate().get_string()=="M*");
+    seq<uint16_t> protein(protein_short);
+    BOOST_CHECK_THROW(protein.translate(),std::invalid_argument);
+    BOOST_CHECK_THROW(seq<uint16_t>(rna).translate(3),std::invalid_argument);
+    BOOST_CHECK_THROW(genetic_code("FFLL"),std::invalid_argument);
+    const std::string mito="FFLLSSSSYY**CCWWLLLLPPPPHHQQRRRRIIMMTTTTNNKKSS**VVVVAAAADDEEGGGG";
+    std::string tga="TGAAGA";
+    BOOST_CHECK(seq<uint16_t>(tga).translate(0,genetic_code(mito)).get_string()=="W*");
+    // the codon tables are cached per genetic code
+    BOOST_CHECK(seq<uint16_t>(tga).translate().get_string()=="*R");
+    BOOST_CHECK(seq<uint16_t>(tga).translate(0,genetic_code(mito)).get_string()=="W*");
+};
+
+BOOST_AUTO_TEST_CASE( arena )
+{
+    std::vector<std::string> reads;
+    for (std::size_t i=0;i<500;i++){
+        std::string r;
+        for (std::size_t j=0;j<150;j++) r.push_back("ACGT"[(i * 13 + j * 7 + j / 3) % 4]);
+        // a few reads widen while they are encoded
+        if (i % 50==7) r[100]='N';
+        reads.push_back(r);
+    };
+    reads.push_back(std::string(5000,'A'));
+    std::vector<seq<uint16_t>> seqs;
+    std::size_t n_bytes=0;
+    {
+        seq_arena arena(4096);
+        for (const std::string & r: reads){
+            seqs.emplace_back(r.data(),r.size(),arena);
+            n_bytes+=codec::packed_size(seqs.back().get_e_type(),r.size());
+        };
+        // widened reads leave no byte array behind
+        BOOST_CHECK(arena.get_used()==n_bytes);
+        BOOST_CHECK(arena.get_reserved()<=arena.get_used() + 4096 * (arena.get_used() / 4000 + 1));
+        // byte arrays follow each other within a slab
+        BOOST_CHECK(seqs[1].get_data()==seqs[0].get_data() + codec::packed_size(NUC_2BITS,150));
+        BOOST_CHECK(seqs[7].get_e_type()==NUC_3BITS);
+        arena.clear();
+        seq<uint16_t> after(reads[0].data(),reads[0].size(),arena);
+        BOOST_CHECK(after.get_string()==reads[0]);
+    };
+    // seqs keep their slabs once the arena is destroyed
+    bool same=true;
+    for (std::size_t i=0;i<reads.size();i++) same=same && seqs[i].get_string()==reads[i];
+    BOOST_CHECK(same);
+    seqs[3].reverse_complement();
+    BOOST_CHECK(seqs[3].subseq(10,20).get_string().size()==20);
+    BOOST_CHECK_THROW(seq_arena invalid(0),std::invalid_argument);
+    // empty reads take no byte array, and no slab
+    seq_arena lazy;
+    seq<uint16_t> none("",0,lazy);
+    BOOST_CHECK(none.get_data()==nullptr && lazy.get_reserved()==0);
+    BOOST_CHECK(seq<uint16_t>(std::string()).get_data()==nullptr);
+    seq<uint16_t> empty;
+    BOOST_CHECK(empty.get_string().empty());
+    BOOST_CHECK(empty.composition().empty());
+};
+
+BOOST_AUTO_TEST_CASE( move_and_views )
+{
+    static_assert(std::is_nothrow_move_constructible_v<seq<uint32_t>>);
+    static_assert(std::is_nothrow_move_assignable_v<seq<uint32_t>>);
+    const std::string text="ACGTTGCAN";
+    // temporaries, const strings, views and literals
+    BOOST_CHECK(seq<uint32_t>(text).get_string()==text);
+    BOOST_CHECK(seq<uint32_t>(std::string("ACGU")).get_m_type()==RNA);
+    BOOST_CHECK(seq<uint32_t>(std::string_view(text).substr(2,4)).get_string()=="GTTG");
+    BOOST_CHECK(seq<uint32_t>("MKDLQE").get_m_type()==PROTEIN);
+    seq<uint32_t> s;
+    s=text;
+    BOOST_CHECK((s="ACGT").get_string()=="ACGT");
+    // moves take the byte array over
+    seq<uint32_t> a(text);
+    const std::byte * d=a.get_data();
+    seq<uint32_t> b(std::move(a));
+    BOOST_CHECK(b.get_data()==d);
+    BOOST_CHECK(b.get_string()==text);
+    BOOST_CHECK(a.size()==0 && a.get_data()==nullptr && a.get_string().empty());
+    std::vector<seq<uint32_t>> queue;
+    queue.push_back(std::move(b));
+    queue.reserve(100);
+    BOOST_CHECK(queue[0].get_data()==d);
+    a=std::move(queue[0]);
+    BOOST_CHECK(a.get_data()==d && queue[0].size()==0);
+    // copies share the byte array, modifiers do not change the other copies
+    seq<uint32_t> c(a);
+    BOOST_CHECK(c.get_data()==d);
+    c.reverse_complement();
+    c.materialize();
+    BOOST_CHECK(c.get_data()!=d);
+    BOOST_CHECK(a.get_string()==text);
+    BOOST_CHECK(c.get_string()=="NTGCAACGT");
+};
+
+BOOST_AUTO_TEST_CASE( parallel_encoding )
+{
+    const unsigned int ini_threads=codec::get_n_threads();
+    const std::size_t ini_chunk=codec::get_chunk_size();
+    std::string text;
+    for (std::size_t i=0;i<5000;i++) text.push_back("ACGTTGCA"[(i * 5 + i / 7) % 8]);
+    std::string widened=text;
+    widened[4321]='N';
+    std::string rna=text;
+    for (char & c: rna) if (c=='T') c='U';
+    for (const std::string & str: {text,widened,rna}){
+        codec::set_n_threads(1);
+        seq<uint16_t> serial(str);
+        codec::set_n_threads(3);
+        codec::set_chunk_size(100);
+        seq<uint16_t> parallel(str);
+        BOOST_CHECK(parallel.get_e_type()==serial.get_e_type());
+        BOOST_CHECK(parallel.get_m_type()==serial.get_m_type());
+        const std::size_t n_bytes=codec::packed_size(serial.get_e_type(),str.size());
+        BOOST_CHECK(std::equal(serial.get_data(),serial.get_data() + n_bytes,parallel.get_data()));
+        BOOST_CHECK(parallel.get_string()==serial.get_string());
+        parallel.reverse_complement();
+        serial.reverse_complement();
+        BOOST_CHECK(parallel.subseq(3,4000).get_string()==serial.subseq(3,4000).get_string());
+        codec::set_chunk_size(ini_chunk);
+    };
+    // inputs widened by the serial path, the parallel one packing them directly
+    std::string late_n=text;
+    late_n[4990]='N';
+    std::string rna_pro=rna;
+    rna_pro[4000]='E';
+    for (const std::string & str: {late_n,rna_pro,std::string(40,'U') + "E",std::string(100,'U') + "E"}){
+        codec::set_n_threads(1);
+        seq<uint16_t> serial(str);
+        codec::set_n_threads(4);
+        codec::set_chunk_size(8);
+        seq<uint16_t> parallel(str);
+        codec::set_chunk_size(ini_chunk);
+        BOOST_CHECK(serial.get_e_type()==parallel.get_e_type());
+        BOOST_CHECK(serial.get_string()==str);
+        const std::size_t n_bytes=codec::packed_size(serial.get_e_type(),str.size());
+        BOOST_CHECK(std::equal(serial.get_data(),serial.get_data() + n_bytes,parallel.get_data()));
+    };
+    std::string invalid=text;
+    invalid[3000]='#';
+    codec::set_chunk_size(100);
+    BOOST_CHECK_THROW(seq<uint16_t> s(invalid),std::invalid_argument);
+    codec::set_chunk_size(ini_chunk);
+    codec::set_n_threads(ini_threads);
+};
+
+BOOST_AUTO_TEST_CASE( builder )
+{
+    const std::string text="ACGTTGCAACGGTACCATGACGTTAGCAAGTCGATCGGATTACA";
+    // chunks of odd sizes, crossing the groups of 8 elements
+    seq_builder<uint16_t> b;
+    std::size_t pos=0;
+    for (std::size_t k: {3,1,7,9,0,5,19}){
+        b.append(std::string_view(text).substr(pos,k));
+        pos+=k;
+    };
+    BOOST_CHECK(b.size()==text.size());
+    seq<uint16_t> s=b.build();
+    seq<uint16_t> ref(text);
+    BOOST_CHECK(b.size()==0);
+    BOOST_CHECK(s.get_string()==text);
+    BOOST_CHECK(s.get_e_type()==NUC_2BITS);
+    BOOST_CHECK(std::equal(ref.get_data(),ref.get_data() + codec::packed_size(NUC_2BITS,text.size()),s.get_data()));
+    // widened in place by the chunks that require it
+    b.append("ACGTA").append("CGN").append("acgtacgtacgtacgtacgt");
+    BOOST_CHECK(b.get_e_type()==NUC_3BITS);
+    b.append("GGRAC");
+    BOOST_CHECK(b.get_e_type()==NUC_4BITS);
+    const std::string mixed="ACGTACGNACGTACGTACGTACGTACGTGGRAC";
+    s=b.build();
+    ref=seq<uint16_t>(mixed);
+    BOOST_CHECK(s.get_string()==mixed);
+    BOOST_CHECK(std::equal(ref.get_data(),ref.get_data() + codec::packed_size(NUC_4BITS,mixed.size()),s.get_data()));
+    b.append("ACG").append("UUA");
+    s=b.build();
+    BOOST_CHECK(s.get_m_type()==RNA);
+    BOOST_CHECK(s.get_string()=="ACGUUA");
+    BOOST_CHECK(b.build().size()==0);
+    // RNA chunks followed by amino-acids, U and T being distinct ones
+    const std::string u16(16,'U');
+    BOOST_CHECK(b.append(u16).append("E").build().get_string()==u16 + "E");
+    BOOST_CHECK(b.append("UUU").append("EK").build().get_string()=="UUUEK");
+    std::string rna_pro;
+    for (std::size_t i=0;i<10;i++) rna_pro+="ACGU";
+    rna_pro+="E";
+    s=b.append(u16).append(rna_pro).build();
+    BOOST_CHECK(s.get_m_type()==PROTEIN);
+    BOOST_CHECK(s.get_string()==u16 + rna_pro);
+    seq_builder<uint16_t> forced(PRO_5BITS);
+    BOOST_CHECK(forced.append(seq<uint16_t>(u16)).append("MKE").build().get_string()==u16 + "MKE");
+    BOOST_CHECK_THROW(b.append("AC#G"),std::invalid_argument);
+    // concatenation of regions, reversed and complemented seqs
+    seq<uint16_t> a(text);
+    seq<uint16_t> n("ACGTNNACGTAC");
+    for (std::size_t i: {0,3,8,11}){
+        for (std::size_t j: {0,5,9}){
+            seq<uint16_t> x=a.subseq(i,20);
+            seq<uint16_t> y=n.subseq(j,3);
+            BOOST_CHECK(concat(x,y).get_string()==x.get_string() + y.get_string());
+            BOOST_CHECK(concat(y,x).get_string()==y.get_string() + x.get_string());
+            x.reverse();
+            BOOST_CHECK(concat(x,y).get_string()==x.get_string() + y.get_string());
+            y.reverse_complement();
+            BOOST_CHECK(concat(x,y).get_string()==x.get_string() + y.get_string());
+            BOOST_CHECK(concat(y,x).get_string()==y.get_string() + x.get_string());
+        };
+    };
+    BOOST_CHECK(concat(a,seq<uint16_t>()).get_string()==text);
+    BOOST_CHECK(concat(seq<uint16_t>(),seq<uint16_t>()).size()==0);
+    seq<uint16_t> p("MKV*LLA",enc_UNDEFINED,PROTEIN);
+    seq<uint16_t> pp=concat(p,p.subseq(1,3));
+    BOOST_CHECK(pp.get_m_type()==PROTEIN);
+    BOOST_CHECK(pp.get_string()=="MKV*LLAKV*");
+    BOOST_CHECK_THROW(concat(a,p),std::invalid_argument);
+};
+
 BOOST_AUTO_TEST_SUITE_END();
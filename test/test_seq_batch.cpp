@@ -0,0 +1,130 @@
+/*
+ * test_seq_batch.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_seq_batch.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+
+using namespace cppbio;
+
+std::string alphabets[]={"ACGT","ACGTN","ACGTRYKMSWBDHVN","ACDEFGHIKLMNPQRSTVWY","ACGU"};
+
+TestFixture1::TestFixture1(){
+    std::mt19937 gen(11);
+    for (std::size_t i=0;i<400;i++){
+        const std::string & alphabet=alphabets[i % 5];
+        std::uniform_int_distribution<std::size_t> pick(0,alphabet.size()-1);
+        std::string r;
+        // mostly 2-bits reads, some of them widened at the end
+        for (std::size_t j=0;j<i % 157;j++) r.push_back(i % 5 ? alphabet[pick(gen)] : "ACGT"[pick(gen) % 4]);
+        if (i % 7==0 && r.size()>20) r[r.size() - 3]='N';
+        reads.push_back(r);
+    }
+};
+
+TestFixture1::~TestFixture1(){
+    for (const std::string & path: paths) std::remove(path.c_str());
+};
+
+std::string TestFixture1::write_file(const std::string & content){
+    char path[]="/tmp/test_seq_batch_XXXXXX";
+    int fd=mkstemp(path);
+    BOOST_REQUIRE(fd>=0);
+    BOOST_REQUIRE(write(fd,content.data(),content.size())==(ssize_t) content.size());
+    close(fd);
+    paths.push_back(path);
+    return(path);
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_seq_batch, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( add_and_view )
+{
+    seq_batch<uint16_t> batch;
+    batch.reserve(reads.size(),64);
+    std::vector<seq<uint16_t>> views;
+    for (const std::string & r: reads){
+        batch.add(r.data(),r.size());
+        // views stay valid as the payload grows
+        views.push_back(batch[batch.size() - 1]);
+    }
+    BOOST_CHECK(batch.size()==reads.size());
+    bool same=true;
+    for (std::size_t i=0;i<reads.size();i++){
+        seq<uint16_t> s(reads[i].data(),reads[i].size());
+        same=same && batch.length(i)==reads[i].size();
+        same=same && batch.get_e_type(i)==s.get_e_type();
+        same=same && batch[i].get_m_type()==s.get_m_type();
+        same=same && batch.get_string(i)==s.get_string();
+        same=same && views[i].get_string()==s.get_string();
+        same=same && batch.get_byte_offset(i + 1) - batch.get_byte_offset(i)==(reads[i].empty() ? 0 : codec::packed_size(s.get_e_type(),reads[i].size()));
+    }
+    BOOST_CHECK(same);
+    BOOST_CHECK(batch.get_e_type(35)==NUC_3BITS);
+    BOOST_CHECK(batch[4].get_string()==reads[4]);
+    // bulk decoding
+    std::vector<std::size_t> ends;
+    std::string all=batch.decode(ends);
+    BOOST_CHECK(ends.size()==reads.size());
+    same=true;
+    for (std::size_t i=0;i<reads.size();i++) same=same && all.substr(i ? ends[i - 1] : 0,reads[i].size())==batch.get_string(i);
+    BOOST_CHECK(same);
+    BOOST_CHECK_THROW(batch[reads.size()],std::out_of_range);
+    // U and T share a nucleotide code, not an amino-acid one
+    std::string rna_pro;
+    for (std::size_t i=0;i<8;i++) rna_pro+="ACGU";
+    rna_pro+="E";
+    batch.add(rna_pro.data(),rna_pro.size());
+    BOOST_CHECK(batch.get_string(reads.size())==rna_pro);
+    BOOST_CHECK(batch.get_e_type(reads.size())==PRO_5BITS);
+    std::string invalid="ACGT#";
+    BOOST_CHECK_THROW(batch.add(invalid.data(),invalid.size()),std::invalid_argument);
+    BOOST_CHECK(batch.size()==reads.size() + 1);
+};
+
+BOOST_AUTO_TEST_CASE( orientation )
+{
+    seq_batch<uint32_t> batch;
+    std::string text=reads[41];
+    seq<uint32_t> s(text);
+    seq<uint32_t> region=s.subseq(3,20);
+    region.reverse_complement();
+    batch.add(region);
+    batch.add(text.data(),text.size());
+    batch.reverse_complement(1);
+    seq<uint32_t> rc(text);
+    rc.reverse_complement();
+    BOOST_CHECK(batch.get_string(0)==region.get_string());
+    BOOST_CHECK(batch[0].get_string()==region.get_string());
+    BOOST_CHECK(batch.get_string(1)==rc.get_string());
+    BOOST_CHECK(batch[1].get_is_rev() && batch[1].get_is_comp());
+    std::vector<std::size_t> ends;
+    BOOST_CHECK(batch.decode(ends)==region.get_string() + rc.get_string());
+    std::string protein="MKDLQE";
+    batch.add(protein.data(),protein.size());
+    BOOST_CHECK(batch[2].get_m_type()==PROTEIN);
+    BOOST_CHECK_THROW(batch.reverse_complement(2),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( fastx )
+{
+    std::string content;
+    for (std::size_t i=0;i<reads.size();i+=5) content+="@read" + std::to_string(i) + "\n" + reads[i] + "\n+\n" + std::string(reads[i].size(),'I') + "\n";
+    fastx_reader reader(write_file(content));
+    seq_batch<uint32_t> batch;
+    BOOST_CHECK(batch.add(reader,10)==10);
+    BOOST_CHECK(batch.add(reader)==reads.size() / 5 - 10);
+    BOOST_CHECK(batch.size()==reads.size() / 5);
+    bool same=true;
+    for (std::size_t i=0;i<batch.size();i++) same=same && batch.get_string(i)==reads[5 * i];
+    BOOST_CHECK(same);
+};
+
+BOOST_AUTO_TEST_SUITE_END();
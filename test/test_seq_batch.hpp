@@ -0,0 +1,30 @@
+/*
+ * test_seq_batch.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_SEQ_BATCH_HPP_
+#define TEST_SEQ_BATCH_HPP_
+
+#include <seq_batch.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::seq_batch"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	~TestFixture1();
+
+	std::vector<std::string> reads; /**< reads of every alphabet */
+	std::vector<std::string> paths; /**< temporary files written by write_file */
+
+	std::string write_file(const std::string & content);
+};
+
+#endif /* TEST_SEQ_BATCH_HPP_ */
@@ -0,0 +1,133 @@
+/*
+ * test_seq_file.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_seq_file.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace cppbio;
+
+std::string names[N_INPUTS]={"chr1","chr2 reversed","chr3","protein",""};
+
+std::string inputs[N_INPUTS]={
+    "AAAATTTCCGACGTACGTACGT",
+    "C-KBDRSTANWHMYGV",
+    "AAAANTTT-CCG",
+    "MKDLQEWAHIVGG-STXPCFNPRY*!",
+    ""
+};
+
+TestFixture1::TestFixture1(){
+    char tmp[]="/tmp/test_seq_file_XXXXXX";
+    int fd=mkstemp(tmp);
+    BOOST_REQUIRE(fd>=0);
+    close(fd);
+    path=tmp;
+    seq_file_writer writer(path);
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        seq<uint32_t> s(inputs[i]);
+        if (i==1) s.reverse();
+        writer.add(names[i],s);
+    };
+    writer.close();
+};
+
+TestFixture1::~TestFixture1(){
+    std::remove(path.c_str());
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_seq_file, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( index )
+{
+    seq_file f(path);
+    BOOST_CHECK(f.size()==N_INPUTS);
+    for (unsigned int i=0;i<N_INPUTS;i++){
+        BOOST_CHECK(f.name(i)==names[i]);
+        BOOST_CHECK(f.contains(names[i]));
+        BOOST_CHECK(f.rank(names[i])==i);
+    };
+    BOOST_CHECK(!f.contains("chr4"));
+    BOOST_CHECK_THROW(f.rank("chr4"),std::out_of_range);
+    BOOST_CHECK_THROW(f.name(N_INPUTS),std::out_of_range);
+};
+
+BOOST_AUTO_TEST_CASE( get )
+{
+    seq_file f(path);
+    BOOST_CHECK(f.get<uint8_t>("chr1").get_string()==inputs[0]);
+    BOOST_CHECK(f.get<uint16_t>("chr2 reversed").get_string()==std::string(inputs[1].rbegin(),inputs[1].rend()));
+    BOOST_CHECK(f.get<uint32_t>(2).get_string()==inputs[2]);
+    BOOST_CHECK(f.get<uint64_t>("protein").get_string()==inputs[3]);
+    BOOST_CHECK(f.get<uint64_t>("").get_string()=="");
+    BOOST_CHECK_THROW(f.get<uint64_t>("chr4"),std::out_of_range);
+};
+
+BOOST_AUTO_TEST_CASE( views_outlive_file )
+{
+    std::vector<seq<uint32_t>> seqs;
+    {
+        seq_file f(path);
+        for (unsigned int i=0;i<N_INPUTS;i++) seqs.push_back(f.get<uint32_t>(i));
+    }
+    BOOST_CHECK(seqs[0].get_string()==inputs[0]);
+    seqs[2].reverse_complement();
+    BOOST_CHECK(seqs[2].get_string()=="CGG-AAANTTTT");
+    BOOST_CHECK(seqs[3].get_string()==inputs[3]);
+};
+
+BOOST_AUTO_TEST_CASE( regions )
+{
+    seq_file_writer writer(path + ".regions");
+    seq<uint32_t> s(inputs[0]);
+    writer.add("start",s.subseq(0,5));
+    writer.add("middle",s.subseq(3,9));
+    writer.close();
+    seq_file f(path + ".regions");
+    BOOST_CHECK(f.get<uint32_t>("start").get_string()==inputs[0].substr(0,5));
+    BOOST_CHECK(f.get<uint32_t>("middle").get_string()==inputs[0].substr(3,9));
+    std::remove((path + ".regions").c_str());
+};
+
+BOOST_AUTO_TEST_CASE( invalid )
+{
+    seq_file_writer writer(path + ".dup");
+    seq<uint8_t> s(inputs[0]);
+    writer.add("a",s);
+    BOOST_CHECK_THROW(writer.add("a",s),std::invalid_argument);
+    writer.close();
+    BOOST_CHECK(seq_file(path + ".dup").size()==1);
+    std::remove((path + ".dup").c_str());
+
+    BOOST_CHECK_THROW(seq_file f("/tmp/test_seq_file_missing"),std::runtime_error);
+    FILE * out=std::fopen((path + ".bad").c_str(),"w");
+    std::fputs(">chr1\nACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGT\n",out);
+    std::fclose(out);
+    BOOST_CHECK_THROW(seq_file f(path + ".bad"),std::runtime_error);
+    std::remove((path + ".bad").c_str());
+
+    // records whose types or element size are out of range
+    std::string bytes;
+    FILE * in=std::fopen(path.c_str(),"r");
+    for (int c=std::fgetc(in);c!=EOF;c=std::fgetc(in)) bytes.push_back(c);
+    std::fclose(in);
+    const seq_file_header * header=reinterpret_cast<const seq_file_header *>(bytes.data());
+    const std::size_t record=header->index_offset;
+    for (const auto & [field,value]: {std::pair<std::size_t,char>{offsetof(seq_file_record,nbits),3},{offsetof(seq_file_record,e_type),9},{offsetof(seq_file_record,e_type),0},{offsetof(seq_file_record,m_type),7}}){
+        std::string corrupted=bytes;
+        corrupted[record + field]=value;
+        out=std::fopen((path + ".bad").c_str(),"w");
+        std::fwrite(corrupted.data(),1,corrupted.size(),out);
+        std::fclose(out);
+        BOOST_CHECK_THROW(seq_file f(path + ".bad"),std::runtime_error);
+        std::remove((path + ".bad").c_str());
+    };
+};
+
+BOOST_AUTO_TEST_SUITE_END();
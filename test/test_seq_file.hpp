@@ -0,0 +1,29 @@
+/*
+ * test_seq_file.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_SEQ_FILE_HPP_
+#define TEST_SEQ_FILE_HPP_
+
+#include <seq_file.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::seq_file"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#define N_INPUTS 5
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	~TestFixture1();
+
+	std::string path; /**< seq file written with the inputs */
+};
+
+#endif /* TEST_SEQ_FILE_HPP_ */
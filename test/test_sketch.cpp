@@ -0,0 +1,102 @@
+/*
+ * test_sketch.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#define BOOST_TEST_DYN_LINK
+
+#include <test_sketch.hpp>
+#include <random>
+#include <vector>
+
+using namespace cppbio;
+
+TestFixture1::TestFixture1(){
+    std::mt19937 gen(21);
+    std::uniform_int_distribution<std::size_t> base(0,3);
+    for (std::size_t j=0;j<20000;j++) genome.push_back("ACGT"[base(gen)]);
+    for (std::size_t j=0;j<20000;j++) other.push_back("ACGT"[base(gen)]);
+    half=genome.substr(0,genome.size() / 2);
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_sketch, TestFixture1);
+
+BOOST_AUTO_TEST_CASE( minimizers_naive )
+{
+    std::string s=genome.substr(0,2000);
+    s[700]='N';
+    seq<uint32_t> encoded(s);
+    const uint8_t k=15,w=10;
+    std::vector<kmer<uint64_t>> all(kmers<uint32_t>(encoded,k).begin(),kmers<uint32_t>(encoded,k).end());
+    // scan every window of w positions
+    std::vector<std::size_t> expected;
+    for (std::size_t end=w-1;end+k<=s.size();end++){
+        const kmer<uint64_t> * best=nullptr;
+        for (const kmer<uint64_t> & m: all){
+            if (m.pos+w<=end || m.pos>end) continue;
+            if (best==nullptr || kmer_hash(m.canonical())<kmer_hash(best->canonical())) best=&m;
+        }
+        if (best && (expected.empty() || expected.back()!=best->pos)) expected.push_back(best->pos);
+    }
+    std::vector<std::size_t> found;
+    for (const minimizer<uint64_t> & m: minimizers<uint32_t>(encoded,k,w)) found.push_back(m.pos);
+    BOOST_CHECK(found==expected);
+    // a seq and its reverse complement share their minimizer codes
+    seq<uint32_t> rc(s);
+    rc.reverse_complement();
+    std::vector<uint64_t> a,b;
+    for (const minimizer<uint64_t> & m: minimizers<uint32_t>(encoded,k,w)) a.push_back(m.code);
+    for (const minimizer<uint64_t> & m: minimizers<uint32_t>(rc,k,w)) b.push_back(m.code);
+    std::sort(a.begin(),a.end());
+    std::sort(b.begin(),b.end());
+    BOOST_CHECK(a==b);
+    BOOST_CHECK_THROW(minimizers<uint32_t>(encoded,k,0),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_CASE( bottom_k )
+{
+    seq<uint32_t> g(genome),h(half),o(other);
+    sketch sg=sketch::bottom(21,1000),sh=sketch::bottom(21,1000),so=sketch::bottom(21,1000);
+    sg.add(g);
+    sh.add(h);
+    so.add(o);
+    BOOST_CHECK(sg.size()==1000);
+    BOOST_CHECK(std::is_sorted(sg.get_hashes().begin(),sg.get_hashes().end()));
+    BOOST_CHECK(sg.jaccard(sg)==1.0);
+    BOOST_CHECK(sg.jaccard(so)<0.01);
+    // the half shares about half of the k-mers of the genome
+    BOOST_CHECK(sh.jaccard(sg)>0.4 && sh.jaccard(sg)<0.6);
+    BOOST_CHECK(sh.containment(sg)>0.95);
+    BOOST_CHECK(sg.containment(sh)>0.4 && sg.containment(sh)<0.6);
+    // adding the seqs in turn sketches their union
+    sketch both=sketch::bottom(21,1000);
+    both.add(h);
+    std::string rest=genome.substr(genome.size() / 2 - 20);
+    seq<uint32_t> second(rest);
+    second.reverse_complement();
+    both.add(second);
+    BOOST_CHECK(both.get_hashes()==sg.get_hashes());
+};
+
+BOOST_AUTO_TEST_CASE( frac_min_hash )
+{
+    seq<uint32_t> g(genome),h(half),o(other);
+    sketch sg=sketch::fraction(31,50),sh=sketch::fraction(31,50),so=sketch::fraction(31,50);
+    sg.add(g);
+    sh.add(h);
+    so.add(o);
+    BOOST_CHECK(sg.size()>200 && sg.size()<600);
+    BOOST_CHECK(sh.containment(sg)==1.0);
+    BOOST_CHECK(sg.jaccard(so)==0.0);
+    BOOST_CHECK(sh.jaccard(sg)>0.4 && sh.jaccard(sg)<0.6);
+    sketch wide=sketch::fraction(40,50);
+    wide.add(g);
+    BOOST_CHECK(wide.size()>200);
+    BOOST_CHECK_THROW(sg.jaccard(wide),std::invalid_argument);
+    BOOST_CHECK_THROW(sg.jaccard(sketch::bottom(31,100)),std::invalid_argument);
+    BOOST_CHECK_THROW(sketch::fraction(65,10),std::invalid_argument);
+    BOOST_CHECK_THROW(sketch::bottom(21,0),std::invalid_argument);
+};
+
+BOOST_AUTO_TEST_SUITE_END();
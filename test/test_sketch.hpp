@@ -0,0 +1,28 @@
+/*
+ * test_sketch.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: jfouret
+ */
+#ifndef TEST_SKETCH_HPP_
+#define TEST_SKETCH_HPP_
+
+#include <sketch.hpp>
+#define BOOST_TEST_MODULE "C++ Unit Tests for cppbio::sketch"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+using namespace cppbio;
+
+struct TestFixture1
+{
+	TestFixture1();
+	// ~TestFixture1(); not needed
+
+	std::string genome; /**< random genome */
+	std::string half; /**< its first half */
+	std::string other; /**< an unrelated random genome */
+};
+
+#endif /* TEST_SKETCH_HPP_ */